@@ -0,0 +1,97 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <sentenCPP/embedding_utils/VectorMaths.h>
+
+namespace sentencpp::embedding_utils {
+
+    // Maps pooled embeddings to a smaller dimension.
+    class ProjectionInterface {
+        public:
+            virtual ~ProjectionInterface() = default;
+
+            [[nodiscard]] virtual std::size_t input_dimension() const = 0;
+            [[nodiscard]] virtual std::size_t output_dimension() const = 0;
+
+            // Projects every row of embeddings into out, a row-major [embeddings.rows, output_dimension()] buffer.
+            // Throws std::invalid_argument if the dimensions or the buffer size do not match.
+            virtual void project(const MatrixView& embeddings, std::span<float> out) const = 0;
+
+            void project(std::span<const float> embedding, std::span<float> out) const;
+            [[nodiscard]] std::vector<float> project(std::span<const float> embedding) const;
+
+            // Mean recall@k of cosine nearest-neighbour search over the projected corpus, measured against exact
+            // search over the original corpus. Queries are usually a held-out sample of the corpus.
+            [[nodiscard]] double recall_at_k(
+                const MatrixView& corpus,
+                const MatrixView& queries,
+                std::size_t k,
+                std::size_t num_threads = 0
+            ) const;
+    };
+
+    // Keeps the leading values of each embedding, for models trained with Matryoshka representation learning.
+    class MatryoshkaTruncation : public ProjectionInterface {
+        public:
+            // renormalise rescales each truncated embedding back to unit length.
+            MatryoshkaTruncation(std::size_t input_dimension, std::size_t output_dimension, bool renormalise = true);
+
+            [[nodiscard]] std::size_t input_dimension() const override { return input_dimension_; }
+            [[nodiscard]] std::size_t output_dimension() const override { return output_dimension_; }
+
+            using ProjectionInterface::project;
+            void project(const MatrixView& embeddings, std::span<float> out) const override;
+
+        private:
+            std::size_t input_dimension_;
+            std::size_t output_dimension_;
+            bool renormalise_;
+    };
+
+    struct PcaConfig {
+        std::size_t output_dimension = 256;
+        bool renormalise = true;        // Rescale projected embeddings to unit length.
+        std::size_t num_threads = 0;    // Threads for the covariance. 0 uses std::thread::hardware_concurrency().
+    };
+
+    // Projects embeddings onto their leading principal components: y = W (x - mean), where the rows of W are the
+    // eigenvectors of the sample covariance with the largest eigenvalues.
+    class PcaProjection : public ProjectionInterface {
+        public:
+            // Fits the projection on a sample of embeddings. Throws std::invalid_argument if the sample has fewer
+            // than two rows or output_dimension is zero or larger than the embedding dimension.
+            PcaProjection(const MatrixView& sample, const PcaConfig& config);
+
+            // Loads a projection written by save(). Throws std::runtime_error if the file is missing or invalid.
+            explicit PcaProjection(const std::string& path);
+
+            void save(const std::string& path) const;
+
+            [[nodiscard]] std::size_t input_dimension() const override { return input_dimension_; }
+            [[nodiscard]] std::size_t output_dimension() const override { return output_dimension_; }
+
+            using ProjectionInterface::project;
+            void project(const MatrixView& embeddings, std::span<float> out) const override;
+
+            [[nodiscard]] std::span<const float> mean() const { return mean_; }
+            [[nodiscard]] MatrixView components() const {
+                return MatrixView{components_.data(), output_dimension_, input_dimension_, input_dimension_};
+            }
+            // Sample variance along each component, in descending order.
+            [[nodiscard]] std::span<const float> explained_variance() const { return explained_variance_; }
+
+        private:
+            std::size_t input_dimension_ = 0;
+            std::size_t output_dimension_ = 0;
+            bool renormalise_ = true;
+            std::vector<float> mean_;
+            std::vector<float> components_;          // [output_dimension, input_dimension], row-major.
+            std::vector<float> explained_variance_;
+            std::vector<float> offsets_;             // W * mean, so projecting is a single product and subtract.
+
+            void compute_offsets();
+    };
+
+} // namespace sentencpp::embedding_utils
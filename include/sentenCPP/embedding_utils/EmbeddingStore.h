@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sentenCPP/embedding_utils/VectorMaths.h>
+
+// On-disk embedding store (POSIX only).
+//
+// <path>      A 4096 byte header followed by one row per embedding. Rows are padded to a multiple of 64 bytes so every
+//             row of a mapped file is cache-line aligned.
+// <path>.ids  One uint64_t id per row, in row order.
+//
+// Rows are only visible to readers once a writer has flushed. Anything appended after the last flush is discarded
+// when the store is reopened.
+
+namespace sentencpp::embedding_utils {
+
+    enum class EmbeddingDType : uint32_t { Float32 = 1 };
+
+    class EmbeddingStoreWriter {
+        public:
+            // Creates the store, or reopens it for appending if it already exists with the same dimension and model
+            // fingerprint. Throws std::runtime_error on I/O errors or a mismatched existing store.
+            EmbeddingStoreWriter(const std::string& path, std::size_t dimension, std::string_view model_fingerprint);
+            ~EmbeddingStoreWriter();
+
+            EmbeddingStoreWriter(const EmbeddingStoreWriter&) = delete;
+            EmbeddingStoreWriter& operator=(const EmbeddingStoreWriter&) = delete;
+
+            // Appends rows and returns the row index of the first one. Safe to call from several threads at once;
+            // each call claims a contiguous block of rows. embeddings must hold ids.size() * dimension floats.
+            // A failed write leaves the writer unusable: later appends and flushes throw, and the store keeps only
+            // the rows published by earlier flushes.
+            std::size_t append(std::span<const uint64_t> ids, std::span<const float> embeddings);
+            std::size_t append(uint64_t id, std::span<const float> embedding);
+
+            // Waits for in-flight appends, syncs the data and publishes the new row count to readers.
+            void flush();
+
+            [[nodiscard]] std::size_t size() const { return next_row_.load(); }
+            [[nodiscard]] std::size_t dimension() const { return dimension_; }
+
+        private:
+            int data_fd_ = -1;
+            int ids_fd_ = -1;
+            std::size_t dimension_;
+            std::size_t row_stride_;  // In bytes.
+            std::atomic<std::size_t> next_row_ = 0;
+            std::atomic<bool> failed_ = false;  // Set when a claimed block of rows could not be written.
+            std::shared_mutex commit_mutex_;    // Shared by appends, exclusive while flushing.
+
+            void write_rows(std::size_t first_row, std::span<const uint64_t> ids, std::span<const float> embeddings) const;
+            void close_files() noexcept;
+    };
+
+    class EmbeddingStoreReader {
+        public:
+            // Maps every flushed row of the store read-only. Throws std::runtime_error if the store is invalid.
+            explicit EmbeddingStoreReader(const std::string& path);
+            ~EmbeddingStoreReader();
+
+            EmbeddingStoreReader(const EmbeddingStoreReader&) = delete;
+            EmbeddingStoreReader& operator=(const EmbeddingStoreReader&) = delete;
+
+            [[nodiscard]] std::size_t size() const { return rows_; }
+            [[nodiscard]] std::size_t dimension() const { return dimension_; }
+            [[nodiscard]] std::string_view model_fingerprint() const { return model_fingerprint_; }
+
+            // Zero-copy views into the mapped files.
+            [[nodiscard]] std::span<const float> row(std::size_t i) const { return matrix().row(i); }
+            [[nodiscard]] MatrixView matrix() const;
+            [[nodiscard]] std::span<const uint64_t> ids() const { return {ids_, rows_}; }
+
+        private:
+            void* data_map_ = nullptr;
+            std::size_t data_map_length_ = 0;
+            void* ids_map_ = nullptr;
+            std::size_t ids_map_length_ = 0;
+
+            const float* rows_data_ = nullptr;
+            const uint64_t* ids_ = nullptr;
+            std::size_t rows_ = 0;
+            std::size_t dimension_ = 0;
+            std::size_t row_stride_ = 0;  // In bytes.
+            std::string model_fingerprint_;
+
+            void unmap() noexcept;
+    };
+
+} // namespace sentencpp::embedding_utils
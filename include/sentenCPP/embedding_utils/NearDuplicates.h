@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include <sentenCPP/embedding_utils/VectorMaths.h>
+
+// Near-duplicate detection with random-hyperplane LSH (SimHash).
+//
+// Each embedding is reduced to a bit signature, one bit per hyperplane, set when the embedding lies on the positive
+// side of it. The signature is cut into bands of rows_per_band bits. Rows that share every bit of at least one band
+// are candidates, and only candidates are compared with an exact cosine similarity.
+
+namespace sentencpp::embedding_utils {
+
+    struct NearDuplicateConfig {
+        float threshold = 0.9f;           // Cosine similarity at or above which two rows are duplicates.
+        // Two rows at angle theta share one bit with probability p = 1 - theta / pi, and become candidates with
+        // probability 1 - (1 - p^rows_per_band)^bands. The defaults find cosine 0.9 pairs about 96% of the time and
+        // cosine 0.95 pairs almost always, while unrelated rows collide in a band once in 4096.
+        std::size_t bands = 20;
+        std::size_t rows_per_band = 12;   // Bits per band, at most 64.
+        uint64_t seed = 0x5eed;           // Seed for the hyperplanes, so signatures are reproducible.
+        std::size_t num_threads = 0;      // 0 uses std::thread::hardware_concurrency().
+        // find_pairs only pairs up the first max_bucket_size rows of a bucket, so a large group of near-identical
+        // rows cannot make it quadratic in time and memory. 0 removes the cap. find_clusters is never capped.
+        std::size_t max_bucket_size = 1024;
+    };
+
+    struct DuplicatePair {
+        std::size_t first;   // Row index, always less than second.
+        std::size_t second;
+        float similarity;
+    };
+
+    class NearDuplicateDetector {
+        public:
+            // Draws bands * rows_per_band Gaussian hyperplanes for embeddings of the given dimension. Throws
+            // std::invalid_argument on an empty dimension or invalid band settings.
+            explicit NearDuplicateDetector(std::size_t dimension, const NearDuplicateConfig& config = {});
+
+            // Number of uint64_t words in one signature.
+            [[nodiscard]] std::size_t signature_words() const { return signature_words_; }
+
+            // Writes the signature of one embedding into out, which must hold signature_words() words.
+            void signature(std::span<const float> embedding, std::span<uint64_t> out) const;
+
+            // Every pair of rows whose cosine similarity reaches the threshold and that share at least one band
+            // (subject to max_bucket_size), sorted by (first, second). Each candidate pair is verified once.
+            [[nodiscard]] std::vector<DuplicatePair> find_pairs(const MatrixView& embeddings) const;
+            [[nodiscard]] std::vector<DuplicatePair> find_pairs(const std::vector<std::vector<float>>& embeddings) const;
+
+            // Groups rows connected by duplicate pairs. Within a bucket a row is only compared with one representative
+            // per group, so the cost stays roughly linear when many rows are near-identical. Only groups of two or
+            // more rows are returned; rows within a cluster are ascending and clusters are ordered by their first row.
+            [[nodiscard]] std::vector<std::vector<std::size_t>> find_clusters(const MatrixView& embeddings) const;
+            [[nodiscard]] std::vector<std::vector<std::size_t>> find_clusters(
+                const std::vector<std::vector<float>>& embeddings
+            ) const;
+
+            [[nodiscard]] const NearDuplicateConfig& get_config() const { return config_; }
+
+        private:
+            NearDuplicateConfig config_;
+            std::size_t dimension_;
+            std::size_t signature_bits_;
+            std::size_t signature_words_;
+            std::vector<float> hyperplanes_;  // [signature_bits, dimension], row-major.
+
+            // Signatures and inverse norms of every row. Throws std::invalid_argument on a dimension mismatch.
+            void compute_signatures(
+                const MatrixView& embeddings,
+                std::vector<uint64_t>& signatures,
+                std::vector<float>& inverse_norms
+            ) const;
+
+            // Fills buckets, which holds one entry per row, with (band key, row), sorted so rows sharing a key are
+            // adjacent.
+            void sort_band(
+                std::span<const uint64_t> signatures,
+                std::size_t band,
+                std::vector<std::pair<uint64_t, uint32_t>>& buckets
+            ) const;
+            [[nodiscard]] uint64_t band_key(const uint64_t* signature, std::size_t band) const;
+    };
+
+} // namespace sentencpp::embedding_utils
@@ -1,9 +1,21 @@
 #pragma once
+#include <span>
 #include <vector>
+#include <utility>
 #include <sentenCPP/tokenizer/TokenizerInterface.h>
 
 namespace sentencpp::embedding_utils {
 
+    // Non-owning view of a row-major matrix whose rows may be padded to a wider stride.
+    struct MatrixView {
+        const float* data = nullptr;
+        std::size_t rows = 0;
+        std::size_t cols = 0;
+        std::size_t stride = 0;  // Distance between consecutive rows, in floats.
+
+        [[nodiscard]] std::span<const float> row(const std::size_t i) const { return {data + i * stride, cols}; }
+    };
+
     class VectorMaths {
         public:
             //
@@ -12,6 +24,14 @@ namespace sentencpp::embedding_utils {
                 const std::vector<tokenizer::Token>& original_tokens
             );
 
+            // Mean pooling over one sequence stored as a flat [sequence_length, hidden_size] block. The hidden size is
+            // taken from sentence_embedding, which receives the result.
+            static void mean_pooling(
+                std::span<const float> token_embeddings,
+                std::span<const int64_t> attention_mask,
+                std::span<float> sentence_embedding
+            );
+
             //
             static std::vector<float> min_pooling(
                 const std::vector<std::vector<float>>& token_embeddings,
@@ -24,22 +44,54 @@ namespace sentencpp::embedding_utils {
                 const std::vector<tokenizer::Token>& original_tokens
             );
 
+            // Dot product of two equally sized vectors, vectorised with SSE/AVX/NEON where available.
+            static float dot_product(
+                std::span<const float> vec_a,
+                std::span<const float> vec_b
+            );
+
             // Calculates Euclidean distance between two vectors.
             static float euclidean_distance(
                 const std::vector<float>& vec_a,
                 const std::vector<float>& vec_b
             );
+            static float euclidean_distance(
+                std::span<const float> vec_a,
+                std::span<const float> vec_b
+            );
 
             // Calculates the cosine similarity between two vectors.
             static float cosine_similarity(
                 const std::vector<float>& vec_a,
                 const std::vector<float>& vec_b
             );
+            static float cosine_similarity(
+                std::span<const float> vec_a,
+                std::span<const float> vec_b
+            );
+
+            // Brute-force search for the k rows most cosine-similar to the query, as (row, similarity) pairs sorted
+            // by descending similarity.
+            static std::vector<std::pair<std::size_t, float>> top_k_cosine(
+                const MatrixView& matrix,
+                std::span<const float> query,
+                std::size_t k
+            );
 
             // Calculates the softmax distribution for a vector of raw scores.
             static std::vector<float> calculate_softmax(
                 const std::vector<float>& logits
             );
+
+            // Approximate e^x of every value, in place, vectorised with SSE/AVX/NEON where available. Relative error
+            // stays within a few ulp; inputs are clamped to [-87.3, 88] so results never overflow to infinity.
+            static void exp_inplace(std::span<float> values);
+
+            // Softmax over every row of a row-major [rows, cols] matrix, in place.
+            static void softmax_rows(std::span<float> matrix, std::size_t cols);
+
+            // Logistic sigmoid of every value, in place.
+            static void sigmoid_inplace(std::span<float> values);
     };
 
 } // namespace sentencpp::embedding_utils
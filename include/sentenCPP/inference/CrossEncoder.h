@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <string_view>
+#include <sentenCPP/tokenizer/WordPiece.h>
+
+#include "OnnxEngine.h"
+
+namespace sentencpp::inference {
+
+    struct CrossEncoderConfig {
+        // Maps raw logits to scores: sigmoid for single-logit models, softmax probability of the last label otherwise.
+        bool apply_activation = true;
+    };
+
+    struct RerankResult {
+        std::size_t index;  // Position of the candidate in the input list.
+        float score;        // Relevance of the candidate to the query. Higher is more relevant.
+    };
+
+    class CrossEncoder {
+        public:
+            // The engine's ModelConfig::output_name should point at the model's logits output.
+            CrossEncoder(const tokenizer::WordPiece& tokenizer, OnnxEngine& engine, const CrossEncoderConfig& config = {});
+
+            // Scores every candidate against the query in a single batched model run, sorted by descending score.
+            // Not thread-safe: buffers are reused between calls.
+            [[nodiscard]] std::vector<RerankResult> rerank(std::string_view query, const std::vector<std::string>& candidates);
+
+        private:
+            const tokenizer::WordPiece& tokenizer_;
+            OnnxEngine& engine_;
+            CrossEncoderConfig config_;
+
+            tokenizer::TokenizerScratch scratch_;
+            std::vector<int64_t> query_ids_;
+            std::vector<int64_t> candidate_ids_;
+            std::vector<int64_t> input_ids_;
+            std::vector<int64_t> attention_mask_;
+            std::vector<int64_t> segment_ids_;
+    };
+
+} // namespace sentencpp::inference
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sentenCPP/tokenizer/WordPiece.h>
+
+#include "OnnxEngine.h"
+
+namespace sentencpp::inference {
+
+    struct ModelBundleConfig {
+        tokenizer::WordPieceConfig tokenizer;
+        ModelConfig model;
+        std::string fingerprint;                                  // Identifies the model version. Defaults to the model path.
+        std::vector<std::string> warmup_texts = {"warm up"};      // Run through the model before the bundle is published.
+    };
+
+    // A tokenizer and the model it belongs to, loaded together and never changed afterwards.
+    class ModelBundle {
+        public:
+            // Loads the tokenizer and model. Throws std::runtime_error if either fails to load.
+            ModelBundle(const ModelBundleConfig& config, uint64_t version);
+
+            ModelBundle(const ModelBundle&) = delete;
+            ModelBundle& operator=(const ModelBundle&) = delete;
+
+            // Runs texts through the tokenizer and model once, so first-run costs such as ORT's arena allocations
+            // are paid before the bundle serves requests.
+            void warm_up(const std::vector<std::string>& texts) const;
+
+            [[nodiscard]] uint64_t version() const { return version_; }
+            [[nodiscard]] const std::string& fingerprint() const { return fingerprint_; }
+            [[nodiscard]] const tokenizer::WordPiece& tokenizer() const { return tokenizer_; }
+
+            // OnnxEngine::run may be called from several threads at once, so the engine is shared by every reader.
+            [[nodiscard]] OnnxEngine& engine() const { return *engine_; }
+
+        private:
+            uint64_t version_;
+            std::string fingerprint_;
+            tokenizer::WordPiece tokenizer_;
+            std::unique_ptr<OnnxEngine> engine_;
+    };
+
+    // Publishes the current ModelBundle to request threads and swaps in new versions without pausing them.
+    //
+    // Readers take a snapshot with acquire(), an atomic shared_ptr load, and keep it for the whole request, so a
+    // request never mixes the tokenizer of one version with the model of another. New versions are loaded and warmed
+    // up on a background thread and then published with a single atomic exchange. A replaced version is released by
+    // the background thread once the last request holding it has finished, so its teardown never lands on a
+    // request thread.
+    class ModelRegistry {
+        public:
+            // Loads, warms up and publishes the first version. Throws std::runtime_error if it fails to load.
+            explicit ModelRegistry(const ModelBundleConfig& config);
+            ~ModelRegistry();
+
+            ModelRegistry(const ModelRegistry&) = delete;
+            ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+            // The current version. Never blocks on a swap in progress.
+            [[nodiscard]] std::shared_ptr<const ModelBundle> acquire() const { return current_.load(); }
+
+            // Queues a new version to be loaded in the background. The future holds the bundle once it has been
+            // published, or the load error, in which case the current version keeps serving. Swaps are applied in the
+            // order they were requested.
+            [[nodiscard]] std::future<std::shared_ptr<const ModelBundle>> swap_async(const ModelBundleConfig& config);
+
+            // Loads and publishes a new version, blocking the caller (but no reader) until it is live.
+            std::shared_ptr<const ModelBundle> swap(const ModelBundleConfig& config);
+
+        private:
+            struct SwapRequest {
+                ModelBundleConfig config;
+                std::promise<std::shared_ptr<const ModelBundle>> published;
+            };
+
+            // Shared with the deleter of every published bundle, which may run after the registry is gone.
+            struct WorkerState {
+                std::mutex mutex;  // Guards the fields below. Readers only take it to drop a version's last reference.
+                std::condition_variable wake;
+                std::deque<SwapRequest> requests;
+                std::vector<const ModelBundle*> released;  // Versions no longer referenced, waiting to be destroyed.
+                bool stopping = false;
+            };
+
+            std::atomic<std::shared_ptr<const ModelBundle>> current_;
+            uint64_t next_version_ = 1;  // Only touched by the constructor and the worker thread.
+            std::shared_ptr<WorkerState> state_ = std::make_shared<WorkerState>();
+            std::thread worker_;
+
+            // Loads queued versions and destroys released ones.
+            void run_worker();
+
+            // Loads and warms up a bundle whose deleter hands it back to the worker once its last reference is dropped.
+            [[nodiscard]] std::shared_ptr<const ModelBundle> load(const ModelBundleConfig& config);
+    };
+
+} // namespace sentencpp::inference
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <string>
 #include <vector>
 #include <sentenCPP/tokenizer/TokenizerInterface.h>
@@ -15,14 +16,35 @@ namespace sentencpp::inference {
         std::string attention_mask_name = "attention_mask";
         std::string token_type_ids_name = "token_type_ids";
         std::string output_name = "last_hidden_state";
+        int intra_op_threads = 1;  // Threads ORT uses inside a single run. 0 lets ORT use one per physical core.
+    };
+
+    // Row-major [batch_size, sequence_length] model inputs. Spans are read in place and must outlive the run.
+    struct BatchInputs {
+        std::span<int64_t> input_ids;
+        std::span<int64_t> attention_mask;
+        std::span<int64_t> segment_ids;
+        int64_t batch_size;
+        int64_t sequence_length;
+    };
+
+    // A float output tensor copied out of the session.
+    struct TensorOutput {
+        std::vector<float> data;
+        std::vector<int64_t> shape;
     };
 
     class OnnxEngine : public InferenceInterface {
         public:
+            // Throws std::runtime_error if the model has no output named config.output_name.
             explicit OnnxEngine(const ModelConfig& config);
 
             [[nodiscard]] std::vector<std::vector<float>> encode(const std::vector<tokenizer::Token>& tokens) override;
 
+            // Runs a whole batch through the model in one session call and returns the configured output, which must
+            // be a float tensor.
+            [[nodiscard]] TensorOutput run(const BatchInputs& inputs);
+
         private:
             ModelConfig config_;  // For configuring data lines in/out of the model.
 
@@ -32,6 +54,12 @@ namespace sentencpp::inference {
 
             std::vector<std::string> input_names;
             std::vector<std::string> output_names;
+
+            // Binds the inputs by name, runs the session and returns every output.
+            std::vector<Ort::Value> run_session(const BatchInputs& inputs);
+
+            // Index of config_.output_name within output_names. Throws std::runtime_error if it is missing.
+            [[nodiscard]] size_t find_output_index() const;
     };
 
 } // namespace sentencpp::inference
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <string_view>
+#include <sentenCPP/tokenizer/WordPiece.h>
+
+#include "OnnxEngine.h"
+
+namespace sentencpp::inference {
+
+    enum class ClassifierActivation {
+        Auto,     // Sigmoid for multi-label or single-logit models, softmax otherwise.
+        Softmax,
+        Sigmoid,
+        None      // Raw logits.
+    };
+
+    struct SequenceClassifierConfig {
+        std::string model_config_path;  // The model's config.json, for id2label and problem_type. Optional.
+        ClassifierActivation activation = ClassifierActivation::Auto;
+        std::size_t top_k = 1;
+    };
+
+    struct LabelScore {
+        std::size_t label_id;
+        std::string_view label;  // Name from id2label, or empty if the config has none. Owned by the classifier.
+        float score;
+    };
+
+    class SequenceClassifier {
+        public:
+            // The engine's ModelConfig::output_name should point at the model's [batch, labels] logits output.
+            // Throws std::runtime_error if model_config_path is set but cannot be read, or holds a label id outside
+            // 0..n-1 for its n labels.
+            SequenceClassifier(
+                const tokenizer::WordPiece& tokenizer,
+                OnnxEngine& engine,
+                const SequenceClassifierConfig& config = {}
+            );
+
+            // Classifies every text in a single batched model run. Returns the top_k labels of each text, by
+            // descending score. Not thread-safe: buffers are reused between calls.
+            [[nodiscard]] std::vector<std::vector<LabelScore>> classify(const std::vector<std::string>& texts);
+            [[nodiscard]] std::vector<LabelScore> classify(std::string_view text);
+
+            [[nodiscard]] const std::vector<std::string>& get_labels() const { return labels_; }
+
+        private:
+            const tokenizer::WordPiece& tokenizer_;
+            OnnxEngine& engine_;
+            SequenceClassifierConfig config_;
+            std::vector<std::string> labels_;  // Indexed by label id.
+            bool multi_label_ = false;
+
+            tokenizer::TokenizerScratch scratch_;
+            std::vector<int64_t> input_ids_;
+            std::vector<int64_t> attention_mask_;
+            std::vector<int64_t> segment_ids_;
+            std::vector<uint32_t> order_;
+
+            // Reads id2label and problem_type from a Hugging Face model config.
+            void load_model_config(const std::string& path);
+    };
+
+} // namespace sentencpp::inference
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sentencpp::tokenizer {
+
+    // An entry of the "added_tokens" array in tokenizer.json.
+    struct AddedToken {
+        std::string content;
+        int64_t id;
+        bool single_word = false;  // Only match when not surrounded by word characters.
+        bool lstrip = false;       // Swallow whitespace to the left of a match.
+        bool rstrip = false;       // Swallow whitespace to the right of a match.
+        bool normalized = true;    // Match against normalised text instead of the raw input.
+        bool special = false;
+    };
+
+    struct AddedTokenMatch {
+        uint32_t begin;  // Byte offset of the match, including any whitespace swallowed by lstrip.
+        uint32_t end;    // Byte offset one past the match, including any whitespace swallowed by rstrip.
+        int64_t id;
+    };
+
+    // Finds added tokens in text using two Aho-Corasick automata: one for tokens matched on raw input and one for
+    // tokens matched on normalised text. A search is a single left-to-right scan whose cost does not depend on how
+    // many tokens were added.
+    class AddedVocabulary {
+        public:
+            AddedVocabulary() = default;
+
+            // Tokens with normalized set must already hold their normalised content. Duplicate contents keep the
+            // first entry.
+            explicit AddedVocabulary(const std::vector<AddedToken>& tokens);
+
+            [[nodiscard]] bool empty() const { return raw_.empty() && normalised_.empty(); }
+            [[nodiscard]] bool has_normalised_tokens() const { return !normalised_.empty(); }
+
+            // Writes the leftmost-longest, non-overlapping matches in text into the caller's buffer, which is
+            // cleared first. normalised selects which set of tokens is searched.
+            void find(std::string_view text, bool normalised, std::vector<AddedTokenMatch>& matches) const;
+
+        private:
+            class Automaton {
+                public:
+                    void add(const AddedToken& token);
+                    void build();
+                    void find(std::string_view text, std::vector<AddedTokenMatch>& matches) const;
+                    [[nodiscard]] bool empty() const { return patterns_.empty(); }
+
+                private:
+                    static constexpr uint32_t none = UINT32_MAX;
+
+                    struct Edge {
+                        uint8_t byte;
+                        uint32_t target;
+                    };
+
+                    struct Node {
+                        uint32_t fail = 0;            // Longest proper suffix that is also a trie node.
+                        uint32_t output = none;       // Pattern ending exactly at this node.
+                        uint32_t dictionary = none;   // Nearest node on the fail chain with an output.
+                        uint32_t depth = 0;
+                        uint32_t edges_begin = 0;     // Children, sorted by byte, in edges_.
+                        uint32_t edges_end = 0;
+                    };
+
+                    struct Pattern {
+                        uint32_t length;
+                        int64_t id;
+                        bool single_word;
+                        bool lstrip;
+                        bool rstrip;
+                    };
+
+                    std::vector<Node> nodes_;
+                    std::vector<Edge> edges_;
+                    uint32_t root_next_[256] = {};     // Dense transitions out of the root.
+                    std::vector<Pattern> patterns_;
+                    std::vector<std::vector<Edge>> building_;  // Per-node children while the trie is being built.
+
+                    [[nodiscard]] uint32_t child(uint32_t node, uint8_t byte) const;
+                    [[nodiscard]] uint32_t next(uint32_t node, uint8_t byte) const;
+                    [[nodiscard]] bool accepts(std::string_view text, const Pattern& pattern, uint32_t begin, uint32_t end) const;
+            };
+
+            Automaton raw_;
+            Automaton normalised_;
+    };
+
+} // namespace sentencpp::tokenizer
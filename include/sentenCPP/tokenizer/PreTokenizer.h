@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace sentencpp::tokenizer {
+
+    enum class CharClass : uint8_t { Word, Whitespace, Punctuation };
+
+    struct WordSpan {
+        uint32_t begin;  // Byte offset of the first byte of the word.
+        uint32_t end;    // Byte offset one past the last byte of the word.
+    };
+
+    class PreTokenizer {
+        public:
+            // Splits UTF-8 text on Unicode whitespace and isolates every punctuation code point, matching the Hugging
+            // Face BertPreTokenizer. Spans are written into the caller's buffer, which is cleared first.
+            static void split(std::string_view text, std::vector<WordSpan>& spans);
+
+            // Looks up the class of a single code point in the precomputed tables.
+            [[nodiscard]] static CharClass classify(char32_t code_point);
+    };
+
+} // namespace sentencpp::tokenizer
@@ -3,7 +3,10 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <span>
 #include <string_view>
+#include <sentenCPP/tokenizer/PreTokenizer.h>
+#include <sentenCPP/tokenizer/AddedVocabulary.h>
 
 namespace sentencpp::tokenizer {
 
@@ -22,6 +25,33 @@ namespace sentencpp::tokenizer {
         }
     };
 
+    // Caller-owned output buffers for the allocation-free tokenize path. Each span must hold at least max_length elements.
+    struct EncodingBuffers {
+        std::span<int64_t> input_ids;       // Token ids, padded up to max_length.
+        std::span<int64_t> attention_mask;  // 1 for real tokens, 0 for padding.
+        std::span<int64_t> segment_ids;     // Token type ids.
+    };
+
+    // Reusable working memory for the allocation-free tokenize path. Buffers keep their capacity between calls, so once
+    // warmed up a call performs no heap allocations. Not thread-safe: give each thread its own instance.
+    struct TokenizerScratch {
+        std::string normalised_text;           // Output of the normalisation steps.
+        std::string swap_text;                 // Second buffer for normalisation steps that cannot work in place.
+        std::string piece;                     // Candidate sub-word currently being looked up.
+        std::vector<WordSpan> words;           // Byte ranges of normalised_text produced by the pre-tokenizer.
+        std::vector<int64_t> word_ids;         // Sub-word ids of the word currently being encoded.
+        std::vector<int64_t> first_ids;        // Sub-word ids of the first text of a pair.
+        std::vector<int64_t> second_ids;       // Sub-word ids of the second text of a pair.
+        std::vector<AddedTokenMatch> raw_matches;         // Added tokens found in the raw input.
+        std::vector<AddedTokenMatch> normalised_matches;  // Added tokens found in the current normalised segment.
+    };
+
+    // How a text pair is shortened when it does not fit in max_length.
+    enum class TruncationStrategy {
+        LongestFirst,  // Trim the longer text one token at a time until the pair fits.
+        OnlySecond     // Trim only the second text.
+    };
+
     struct TokenizerBaseConfig {
         std::size_t max_input_chars_per_word = 100;
         std::size_t max_length = 128;
@@ -29,6 +59,8 @@ namespace sentencpp::tokenizer {
         bool strip_accents = true;
         bool clean_text = true;
         bool handle_chinese_chars = true;
+        TruncationStrategy truncation_strategy = TruncationStrategy::LongestFirst;  // Only used for text pairs.
+        bool warn_on_truncation = true;  // Print a warning to stderr whenever input is truncated.
         std::string padding_token = "[PAD]";
         std::string unknown_token = "[UNK]";
         std::string classification_token = "[CLS]";
@@ -39,6 +71,7 @@ namespace sentencpp::tokenizer {
     struct WordPieceConfig : public TokenizerBaseConfig {
         std::string config_path;  // Path to the config file. Eg: "tokenizer.json".
         std::string vocab_key = "/model/vocab";  // Path to the vocabulary object within the config file. Eg: "/model/vocab".
+        std::string added_tokens_key = "/added_tokens";  // Path to the added tokens array within the config file. Optional.
     };
 
     struct BPEConfig : public TokenizerBaseConfig {
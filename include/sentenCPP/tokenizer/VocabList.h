@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -15,33 +17,50 @@ namespace sentencpp::tokenizer {
             VocabList() = default;
 
             // Add a key value pair to the mappings.
-            bool set_token(const std::string& token_str, int64_t token_id);
+            bool set_token(std::string_view token_str, int64_t token_id);
             bool set_special_token(const std::string& token_str, TokenRole token_role);
 
-            [[nodiscard]] const std::unordered_map<std::string, int64_t>& get_string_to_id_map() const { return string_to_id_map_; }
-            [[nodiscard]] const std::vector<std::string>& get_id_to_string_map() const { return id_to_string_map_; }
+            // Materialised copies of the mappings. These allocate on every call; prefer the lookups below.
+            [[nodiscard]] std::unordered_map<std::string, int64_t> get_string_to_id_map() const;
+            [[nodiscard]] std::vector<std::string> get_id_to_string_map() const;
 
             [[nodiscard]] const std::unordered_map<TokenRole, std::string>& get_special_tokens_map_() const { return special_tokens_map_; }
             [[nodiscard]] std::string get_special_token_val(const TokenRole token_role) const { return special_tokens_map_.at(token_role); }
 
-            [[nodiscard]] std::optional<int64_t> token_to_id(const std::string& token_str) const;
+            [[nodiscard]] std::optional<int64_t> token_to_id(std::string_view token_str) const;
             [[nodiscard]] std::optional<std::string> id_to_token(int64_t token_id) const;
 
-            [[nodiscard]] size_t size() const { return id_to_string_map_.size(); }
+            // Non-owning view into the string pool. Valid until the next call to set_token.
+            [[nodiscard]] std::optional<std::string_view> id_to_token_view(int64_t token_id) const;
+
+            [[nodiscard]] size_t size() const { return id_to_ref_.size(); }
             friend std::ostream& operator<<(std::ostream& os, const VocabList& instance);
 
         private:
-            std::unordered_map<std::string, int64_t> string_to_id_map_;
-            std::vector<std::string> id_to_string_map_;
+            // Location of a token's bytes in pool_. A length of 0 marks an unused id.
+            struct TokenRef {
+                uint32_t offset;
+                uint32_t length;
+            };
+
+            // Open-addressing hash table slot. Stores the low hash bits so most mismatches never touch the pool.
+            struct Slot {
+                uint32_t hash;
+                uint32_t id;
+            };
+
+            static constexpr uint32_t empty_slot = UINT32_MAX;
+
+            std::string pool_;                  // Every token's bytes, back to back.
+            std::vector<TokenRef> id_to_ref_;   // Indexed by token id.
+            std::vector<Slot> slots_;           // Power-of-two sized, linear probing, at most half full.
+            std::size_t token_count_ = 0;
             std::unordered_map<TokenRole, std::string> special_tokens_map_;
 
-            // std::unordered_map<std::string, std::string> special_tokens_map_ = {
-            //     {"padding", "[PAD]"},
-            //     {"unknown", "[UNK]"},
-            //     {"classification", "[CLS]"},
-            //     {"separator", "[SEP]"},
-            //     {"mask", "[MASK]"}
-            // };
+            [[nodiscard]] std::string_view ref_to_view(TokenRef ref) const { return {pool_.data() + ref.offset, ref.length}; }
+            [[nodiscard]] const Slot* find_slot(std::string_view token_str, uint32_t hash) const;
+            void insert_slot(uint32_t hash, uint32_t id);
+            void grow_slots();
     };
 
 } // namespace sentencpp::tokenizer
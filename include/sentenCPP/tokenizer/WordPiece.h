@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <iostream>
 #include <sentenCPP/tokenizer/VocabList.h>
 #include <sentenCPP/tokenizer/TokenizerInterface.h>
@@ -10,31 +11,84 @@ namespace sentencpp::tokenizer {
 
     class WordPiece : public TokenizerInterface {
         public:
+            // Throws std::runtime_error if the config file cannot be read or lacks a required special token, and
+            // std::invalid_argument if max_length is less than 2.
             explicit WordPiece(const WordPieceConfig& config);
 
             [[nodiscard]] std::vector<Token> tokenize(std::string_view text) const override;
 
+            // Allocation-free variant of tokenize. Writes max_length ids, masks and segments into the caller's buffers
+            // and returns the number of non-padding tokens. Throws std::invalid_argument if a buffer is too small.
+            std::size_t tokenize(std::string_view text, TokenizerScratch& scratch, const EncodingBuffers& out) const;
+
+            // Tokenize a text pair as [CLS] first [SEP] second [SEP], with segment ids 0 and 1 respectively. Throws
+            // std::invalid_argument if max_length is less than 3.
+            [[nodiscard]] std::vector<Token> tokenize_pair(std::string_view first, std::string_view second) const;
+            std::size_t tokenize_pair(
+                std::string_view first,
+                std::string_view second,
+                TokenizerScratch& scratch,
+                const EncodingBuffers& out
+            ) const;
+
+            // Normalises and encodes text into sub-word ids, without special tokens, truncation or padding.
+            void encode_ids(std::string_view text, TokenizerScratch& scratch, std::vector<int64_t>& ids) const;
+
+            // Builds a padded pair encoding from ids produced by encode_ids, truncating with the configured strategy.
+            // Lets a text shared by many pairs (eg: a query) be encoded once. Returns the number of non-padding tokens.
+            // Throws std::invalid_argument if max_length is less than 3 or a buffer is too small.
+            std::size_t assemble_pair(
+                std::span<const int64_t> first,
+                std::span<const int64_t> second,
+                const EncodingBuffers& out
+            ) const;
+
             [[nodiscard]] size_t get_vocab_size() const override { return vocab_list_->size(); }
             [[nodiscard]] const VocabList& get_vocab_list() const { return *vocab_list_; }
+            [[nodiscard]] const WordPieceConfig& get_config() const { return config_; }
 
         private:
             WordPieceConfig config_;
             std::unique_ptr<VocabList> vocab_list_;
+            AddedVocabulary added_vocabulary_;
+
+            // Special token ids, resolved once at construction.
+            int64_t padding_id_ = 0;
+            int64_t unknown_id_ = 0;
+            int64_t classification_id_ = 0;
+            int64_t separator_id_ = 0;
+
+            // Throws std::invalid_argument unless every buffer holds at least max_length elements.
+            void check_buffers(const EncodingBuffers& out) const;
+
+            // Runs the configured normalisation steps, leaving the result in scratch.normalised_text.
+            void normalise(std::string_view text, TokenizerScratch& scratch) const;
+
+            // Text reported for an id encoded from word: its vocabulary entry, or the word itself if the id is [UNK] or
+            // an added token that could not be registered in the vocabulary.
+            [[nodiscard]] std::string_view token_text(int64_t id, std::string_view word) const;
+
+            // Splits out added tokens, then normalises, pre-tokenizes and encodes the rest. Calls
+            // visit(std::string_view word, std::span<const int64_t> ids) for every word and added token in order; an
+            // unknown word is reported as a lone [UNK] id. Stops early once visit returns false.
+            template <typename Visitor>
+            void encode_text(std::string_view text, TokenizerScratch& scratch, Visitor&& visit) const;
 
-            // Splits text by whitespace and punctuation.
-            [[nodiscard]] static std::vector<std::string_view> split_text(std::string_view text);
+            // Encodes one segment of raw text that contains no raw-matched added tokens. Returns false if stopped early.
+            template <typename Visitor>
+            bool encode_segment(std::string_view segment, TokenizerScratch& scratch, Visitor& visit) const;
 
-            // Encode each word into one or more tokens (using MaxMatch algorithm).
-            [[nodiscard]] std::vector<Token> encode_word(std::string_view word) const;
+            // Encode a word into scratch.word_ids (using MaxMatch algorithm). Returns false if the word is unknown.
+            [[nodiscard]] bool encode_word(std::string_view word, TokenizerScratch& scratch) const;
 
-            // Truncation and adding special tokens.
+            // Truncation and adding special tokens. Expects [CLS] to already be at the front of tokens.
             void post_processing(std::vector<Token>& tokens) const;
 
             // Normalising user input.
-            static void clean_text_inplace(std::string& text);
+            static void clean_text(std::string_view text, std::string& out);
             static void to_lowercase_inplace(std::string& text);
-            static void strip_accents_inplace(std::string& text);
-            static void handle_chinese_chars_inplace(std::string& text);
+            static void strip_accents(std::string_view text, std::string& out);
+            static void pad_chinese_chars(std::string_view text, std::string& out);
     };
 
 } // namespace sentencpp::tokenizer
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <deque>
+#include <unicode/uchar.h>
+#include <unicode/utf8.h>
+#include <sentenCPP/tokenizer/AddedVocabulary.h>
+
+namespace sentencpp::tokenizer {
+
+    namespace {
+
+        bool is_word_char(const UChar32 c) {
+            return c == '_' || u_isalnum(c);
+        }
+
+        // Code point ending just before offset, or -1 at the start of text.
+        UChar32 code_point_before(const std::string_view text, int32_t offset) {
+            if (offset <= 0) return -1;
+            UChar32 c;
+            U8_PREV(reinterpret_cast<const uint8_t*>(text.data()), 0, offset, c);
+            return c;
+        }
+
+        // Code point starting at offset, or -1 at the end of text.
+        UChar32 code_point_at(const std::string_view text, int32_t offset) {
+            if (offset >= static_cast<int32_t>(text.length())) return -1;
+            UChar32 c;
+            U8_NEXT(reinterpret_cast<const uint8_t*>(text.data()), offset, static_cast<int32_t>(text.length()), c);
+            return c;
+        }
+
+    } // namespace
+
+    AddedVocabulary::AddedVocabulary(const std::vector<AddedToken>& tokens) {
+        for (const auto& token : tokens) {
+            if (token.content.empty()) continue;
+            if (token.normalized) normalised_.add(token);
+            else raw_.add(token);
+        }
+        raw_.build();
+        normalised_.build();
+    }
+
+
+    // PUBLIC METHODS --------------------------------------------------------------------------------------------------
+
+    void AddedVocabulary::find(const std::string_view text, const bool normalised, std::vector<AddedTokenMatch>& matches) const {
+        matches.clear();
+        const Automaton& automaton = normalised ? normalised_ : raw_;
+        if (!automaton.empty()) automaton.find(text, matches);
+    }
+
+
+    // PRIVATE METHODS -------------------------------------------------------------------------------------------------
+
+    void AddedVocabulary::Automaton::add(const AddedToken& token) {
+        if (nodes_.empty()) {
+            nodes_.emplace_back();
+            building_.emplace_back();
+        }
+
+        uint32_t node = 0;
+        for (const char ch : token.content) {
+            const auto byte = static_cast<uint8_t>(ch);
+            auto& children = building_[node];
+            const auto it = std::ranges::find(children, byte, &Edge::byte);
+            if (it != children.end()) {
+                node = it->target;
+                continue;
+            }
+
+            const auto created = static_cast<uint32_t>(nodes_.size());
+            children.push_back(Edge{byte, created});
+            Node child_node;
+            child_node.depth = nodes_[node].depth + 1;
+            nodes_.push_back(child_node);
+            building_.emplace_back();
+            node = created;
+        }
+
+        if (nodes_[node].output != none) return;
+        nodes_[node].output = static_cast<uint32_t>(patterns_.size());
+        patterns_.push_back(Pattern{
+            static_cast<uint32_t>(token.content.size()), token.id, token.single_word, token.lstrip, token.rstrip
+        });
+    }
+
+    void AddedVocabulary::Automaton::build() {
+        if (nodes_.empty()) return;
+
+        // Flatten the per-node child lists into one sorted edge array.
+        for (uint32_t node = 0; node < nodes_.size(); ++node) {
+            auto& children = building_[node];
+            std::ranges::sort(children, {}, &Edge::byte);
+            nodes_[node].edges_begin = static_cast<uint32_t>(edges_.size());
+            edges_.insert(edges_.end(), children.begin(), children.end());
+            nodes_[node].edges_end = static_cast<uint32_t>(edges_.size());
+        }
+        building_.clear();
+        building_.shrink_to_fit();
+
+        for (int byte = 0; byte < 256; ++byte) {
+            const uint32_t target = child(0, static_cast<uint8_t>(byte));
+            root_next_[byte] = target == none ? 0 : target;
+        }
+
+        // Breadth-first, so every fail target is finished before the nodes that point at it.
+        std::deque<uint32_t> queue;
+        for (uint32_t e = nodes_[0].edges_begin; e < nodes_[0].edges_end; ++e) queue.push_back(edges_[e].target);
+
+        while (!queue.empty()) {
+            const uint32_t node = queue.front();
+            queue.pop_front();
+
+            for (uint32_t e = nodes_[node].edges_begin; e < nodes_[node].edges_end; ++e) {
+                const auto [byte, target] = edges_[e];
+                const uint32_t fail = next(nodes_[node].fail, byte);
+                nodes_[target].fail = fail;
+                nodes_[target].dictionary = nodes_[fail].output != none ? fail : nodes_[fail].dictionary;
+                queue.push_back(target);
+            }
+        }
+    }
+
+    void AddedVocabulary::Automaton::find(const std::string_view text, std::vector<AddedTokenMatch>& matches) const {
+        const auto* data = reinterpret_cast<const uint8_t*>(text.data());
+        const auto n = static_cast<uint32_t>(text.length());
+        uint32_t pos = 0;
+        uint32_t previous_end = 0;
+
+        while (pos < n) {
+            uint32_t state = 0;
+            uint32_t best = none;
+            uint32_t best_begin = 0;
+
+            for (uint32_t i = pos; i < n; ) {
+                state = next(state, data[i++]);
+
+                // Every pattern ending here, longest first.
+                const uint32_t first = nodes_[state].output != none ? state : nodes_[state].dictionary;
+                for (uint32_t o = first; o != none; o = nodes_[o].dictionary) {
+                    const uint32_t pattern = nodes_[o].output;
+                    const uint32_t begin = i - patterns_[pattern].length;
+                    const bool better = best == none || begin < best_begin ||
+                        (begin == best_begin && patterns_[pattern].length > patterns_[best].length);
+                    if (better && accepts(text, patterns_[pattern], begin, i)) {
+                        best = pattern;
+                        best_begin = begin;
+                    }
+                }
+
+                // Stop once no partial match in progress can start at or before the best match.
+                if (best != none && i - nodes_[state].depth > best_begin) break;
+            }
+
+            if (best == none) return;
+
+            const Pattern& pattern = patterns_[best];
+            auto begin = static_cast<int32_t>(best_begin);
+            auto end = static_cast<int32_t>(best_begin + pattern.length);
+
+            if (pattern.lstrip) {
+                while (begin > static_cast<int32_t>(previous_end)) {
+                    int32_t prev = begin;
+                    UChar32 c;
+                    U8_PREV(data, static_cast<int32_t>(previous_end), prev, c);
+                    if (c < 0 || !u_isUWhiteSpace(c)) break;
+                    begin = prev;
+                }
+            }
+            if (pattern.rstrip) {
+                while (end < static_cast<int32_t>(n)) {
+                    int32_t after = end;
+                    UChar32 c;
+                    U8_NEXT(data, after, static_cast<int32_t>(n), c);
+                    if (c < 0 || !u_isUWhiteSpace(c)) break;
+                    end = after;
+                }
+            }
+
+            matches.push_back(AddedTokenMatch{static_cast<uint32_t>(begin), static_cast<uint32_t>(end), pattern.id});
+            pos = previous_end = static_cast<uint32_t>(end);
+        }
+    }
+
+    uint32_t AddedVocabulary::Automaton::child(const uint32_t node, const uint8_t byte) const {
+        const auto first = edges_.begin() + nodes_[node].edges_begin;
+        const auto last = edges_.begin() + nodes_[node].edges_end;
+        const auto it = std::lower_bound(first, last, byte, [](const Edge& edge, const uint8_t b) { return edge.byte < b; });
+        return it != last && it->byte == byte ? it->target : none;
+    }
+
+    uint32_t AddedVocabulary::Automaton::next(uint32_t node, const uint8_t byte) const {
+        while (node != 0) {
+            const uint32_t target = child(node, byte);
+            if (target != none) return target;
+            node = nodes_[node].fail;
+        }
+        return root_next_[byte];
+    }
+
+    bool AddedVocabulary::Automaton::accepts(
+        const std::string_view text,
+        const Pattern& pattern,
+        const uint32_t begin,
+        const uint32_t end
+    ) const {
+        if (!pattern.single_word) return true;
+        const UChar32 before = code_point_before(text, static_cast<int32_t>(begin));
+        const UChar32 after = code_point_at(text, static_cast<int32_t>(end));
+        return (before < 0 || !is_word_char(before)) && (after < 0 || !is_word_char(after));
+    }
+
+} // namespace sentencpp::tokenizer
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <sentenCPP/inference/OnnxEngine.h>
+#include <sentenCPP/tokenizer/TokenizerInterface.h>
+
+// Internal helper for building the inputs of a batched model run. Not installed with the public headers.
+namespace sentencpp::detail {
+
+    // Encodes batch_size rows into the three buffers, each resized to [batch_size, max_length]. encode_row(row, out)
+    // writes one row into out and returns its length. Padding columns that no row uses are then dropped by repacking
+    // rows to a stride of the longest row, and the returned inputs view the packed [batch_size, longest] prefix.
+    template <typename EncodeRow>
+    inference::BatchInputs encode_batch(
+        const std::size_t batch_size,
+        const std::size_t max_length,
+        std::vector<int64_t>& input_ids,
+        std::vector<int64_t>& attention_mask,
+        std::vector<int64_t>& segment_ids,
+        EncodeRow&& encode_row
+    ) {
+        input_ids.resize(batch_size * max_length);
+        attention_mask.resize(batch_size * max_length);
+        segment_ids.resize(batch_size * max_length);
+
+        std::size_t longest = 0;
+        for (std::size_t row = 0; row < batch_size; ++row) {
+            const std::size_t offset = row * max_length;
+            const std::size_t length = encode_row(row, tokenizer::EncodingBuffers{
+                std::span(input_ids).subspan(offset, max_length),
+                std::span(attention_mask).subspan(offset, max_length),
+                std::span(segment_ids).subspan(offset, max_length)
+            });
+            longest = std::max(longest, length);
+        }
+
+        if (longest < max_length) {
+            for (std::size_t row = 1; row < batch_size; ++row) {
+                const std::size_t from = row * max_length;
+                const std::size_t to = row * longest;
+                std::copy_n(input_ids.begin() + from, longest, input_ids.begin() + to);
+                std::copy_n(attention_mask.begin() + from, longest, attention_mask.begin() + to);
+                std::copy_n(segment_ids.begin() + from, longest, segment_ids.begin() + to);
+            }
+        }
+
+        const std::size_t element_count = batch_size * longest;
+        return inference::BatchInputs{
+            std::span(input_ids).first(element_count),
+            std::span(attention_mask).first(element_count),
+            std::span(segment_ids).first(element_count),
+            static_cast<int64_t>(batch_size),
+            static_cast<int64_t>(longest)
+        };
+    }
+
+} // namespace sentencpp::detail
@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <stdexcept>
+#include <sentenCPP/inference/CrossEncoder.h>
+#include <sentenCPP/embedding_utils/VectorMaths.h>
+#include "BatchEncoding.h"
+
+namespace sentencpp::inference {
+
+    CrossEncoder::CrossEncoder(
+        const tokenizer::WordPiece& tokenizer,
+        OnnxEngine& engine,
+        const CrossEncoderConfig& config
+    ) :
+        tokenizer_(tokenizer),
+        engine_(engine),
+        config_(config)
+    {}
+
+
+    // PUBLIC METHODS --------------------------------------------------------------------------------------------------
+
+    std::vector<RerankResult> CrossEncoder::rerank(std::string_view query, const std::vector<std::string>& candidates) {
+        if (candidates.empty()) return {};
+
+        // The query is normalised and encoded once, then shared by every pair.
+        tokenizer_.encode_ids(query, scratch_, query_ids_);
+
+        const std::size_t batch_size = candidates.size();
+        const BatchInputs inputs = detail::encode_batch(batch_size, tokenizer_.get_config().max_length, input_ids_,
+            attention_mask_, segment_ids_, [&](const std::size_t row, const tokenizer::EncodingBuffers& out) {
+                tokenizer_.encode_ids(candidates[row], scratch_, candidate_ids_);
+                return tokenizer_.assemble_pair(query_ids_, candidate_ids_, out);
+            });
+        TensorOutput logits = engine_.run(inputs);
+
+        if (logits.data.size() < batch_size) {
+            throw std::runtime_error("Cross-encoder output holds fewer values than the number of candidates.");
+        }
+
+        const std::size_t num_labels = logits.data.size() / batch_size;
+        if (config_.apply_activation) {
+            if (num_labels == 1) embedding_utils::VectorMaths::sigmoid_inplace(logits.data);
+            else embedding_utils::VectorMaths::softmax_rows(logits.data, num_labels);
+        }
+
+        std::vector<RerankResult> results;
+        results.reserve(batch_size);
+        for (std::size_t row = 0; row < batch_size; ++row) {
+            results.push_back(RerankResult{row, logits.data[row * num_labels + num_labels - 1]});
+        }
+
+        std::ranges::stable_sort(results, [](const RerankResult& a, const RerankResult& b) { return a.score > b.score; });
+        return results;
+    }
+
+} // namespace sentencpp::inference
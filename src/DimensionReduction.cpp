@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_set>
+#include <sentenCPP/embedding_utils/DimensionReduction.h>
+#include "Workers.h"
+
+namespace sentencpp::embedding_utils {
+
+    using detail::resolve_threads;
+    using detail::run_workers;
+
+    namespace {
+
+        constexpr char pca_magic[8] = {'S', 'C', 'P', 'P', 'P', 'C', 'A', '\0'};
+        constexpr uint32_t pca_version = 1;
+
+        struct PcaFileHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t renormalise;
+            uint64_t input_dimension;
+            uint64_t output_dimension;
+        };
+
+        // Rows projected per block, so each component row is reused while it is in cache.
+        constexpr std::size_t project_block_rows = 8;
+
+        void normalise_inplace(const std::span<float> values) {
+            const float norm = std::sqrt(VectorMaths::dot_product(values, values));
+            if (norm == 0.0f) return;
+            const float inverse = 1.0f / norm;
+            for (float& val : values) val *= inverse;
+        }
+
+        void check_projection_buffers(const MatrixView& embeddings, const std::span<float> out, const std::size_t input,
+                                      const std::size_t output) {
+            if (embeddings.rows > 0 && embeddings.cols != input) {
+                throw std::invalid_argument("Embedding dimension does not match the projection input dimension.");
+            }
+            if (out.size() < embeddings.rows * output) {
+                throw std::invalid_argument("Projection output buffer must hold rows * output_dimension floats.");
+            }
+        }
+
+        // Householder reduction of the symmetric n x n matrix in v to tridiagonal form, accumulating the
+        // transformations in v. On return d holds the diagonal and e the sub-diagonal in e[1..n-1]. Adapted from
+        // the public domain JAMA port of the EISPACK routine tred2.
+        //
+        // V is stored column-major, which turns every O(n^3) loop into a walk along contiguous memory. The input is
+        // symmetric so its layout does not matter, and the output is the transposed layout diagonalise expects.
+        void tridiagonalise(std::vector<double>& v, std::vector<double>& d, std::vector<double>& e, const std::size_t n) {
+            const auto V = [&v, n](const std::size_t row, const std::size_t col) -> double& { return v[col * n + row]; };
+
+            for (std::size_t j = 0; j < n; ++j) d[j] = V(n - 1, j);
+
+            for (std::size_t i = n - 1; i > 0; --i) {
+                double scale = 0.0;
+                double h = 0.0;
+                for (std::size_t k = 0; k < i; ++k) scale += std::abs(d[k]);
+
+                if (scale == 0.0) {
+                    e[i] = d[i - 1];
+                    for (std::size_t j = 0; j < i; ++j) {
+                        d[j] = V(i - 1, j);
+                        V(i, j) = 0.0;
+                        V(j, i) = 0.0;
+                    }
+                } else {
+                    for (std::size_t k = 0; k < i; ++k) {
+                        d[k] /= scale;
+                        h += d[k] * d[k];
+                    }
+                    double f = d[i - 1];
+                    double g = f > 0 ? -std::sqrt(h) : std::sqrt(h);
+                    e[i] = scale * g;
+                    h -= f * g;
+                    d[i - 1] = f - g;
+                    for (std::size_t j = 0; j < i; ++j) e[j] = 0.0;
+
+                    for (std::size_t j = 0; j < i; ++j) {
+                        f = d[j];
+                        V(j, i) = f;
+                        g = e[j] + V(j, j) * f;
+                        for (std::size_t k = j + 1; k < i; ++k) {
+                            g += V(k, j) * d[k];
+                            e[k] += V(k, j) * f;
+                        }
+                        e[j] = g;
+                    }
+
+                    f = 0.0;
+                    for (std::size_t j = 0; j < i; ++j) {
+                        e[j] /= h;
+                        f += e[j] * d[j];
+                    }
+                    const double hh = f / (h + h);
+                    for (std::size_t j = 0; j < i; ++j) e[j] -= hh * d[j];
+
+                    for (std::size_t j = 0; j < i; ++j) {
+                        f = d[j];
+                        g = e[j];
+                        for (std::size_t k = j; k < i; ++k) V(k, j) -= f * e[k] + g * d[k];
+                        d[j] = V(i - 1, j);
+                        V(i, j) = 0.0;
+                    }
+                }
+                d[i] = h;
+            }
+
+            // Accumulate the transformations.
+            for (std::size_t i = 0; i + 1 < n; ++i) {
+                V(n - 1, i) = V(i, i);
+                V(i, i) = 1.0;
+                const double h = d[i + 1];
+                if (h != 0.0) {
+                    for (std::size_t k = 0; k <= i; ++k) d[k] = V(k, i + 1) / h;
+                    for (std::size_t j = 0; j <= i; ++j) {
+                        double g = 0.0;
+                        for (std::size_t k = 0; k <= i; ++k) g += V(k, i + 1) * V(k, j);
+                        for (std::size_t k = 0; k <= i; ++k) V(k, j) -= g * d[k];
+                    }
+                }
+                for (std::size_t k = 0; k <= i; ++k) V(k, i + 1) = 0.0;
+            }
+            for (std::size_t j = 0; j < n; ++j) {
+                d[j] = V(n - 1, j);
+                V(n - 1, j) = 0.0;
+            }
+            V(n - 1, n - 1) = 1.0;
+            e[0] = 0.0;
+        }
+
+        // Implicit QL iterations on the tridiagonal matrix from tridiagonalise, whose transformations vt holds
+        // transposed. On return d holds the eigenvalues and row i of vt the eigenvector of d[i], so each rotation
+        // touches two contiguous rows. Adapted from the JAMA port of the EISPACK routine tql2.
+        void diagonalise(std::vector<double>& vt, std::vector<double>& d, std::vector<double>& e, const std::size_t n) {
+            for (std::size_t i = 1; i < n; ++i) e[i - 1] = e[i];
+            e[n - 1] = 0.0;
+
+            double f = 0.0;
+            double tst1 = 0.0;
+            const double eps = std::ldexp(1.0, -52);
+
+            for (std::size_t l = 0; l < n; ++l) {
+                tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+                std::size_t m = l;
+                while (m < n && std::abs(e[m]) > eps * tst1) ++m;
+                if (m == n) m = n - 1;
+
+                if (m > l) {
+                    do {
+                        double g = d[l];
+                        double p = (d[l + 1] - g) / (2.0 * e[l]);
+                        double r = std::hypot(p, 1.0);
+                        if (p < 0) r = -r;
+                        d[l] = e[l] / (p + r);
+                        d[l + 1] = e[l] * (p + r);
+                        const double dl1 = d[l + 1];
+                        double h = g - d[l];
+                        for (std::size_t i = l + 2; i < n; ++i) d[i] -= h;
+                        f += h;
+
+                        p = d[m];
+                        double c = 1.0, c2 = 1.0, c3 = 1.0;
+                        const double el1 = e[l + 1];
+                        double s = 0.0, s2 = 0.0;
+                        for (std::size_t i = m; i-- > l; ) {
+                            c3 = c2;
+                            c2 = c;
+                            s2 = s;
+                            g = c * e[i];
+                            h = c * p;
+                            r = std::hypot(p, e[i]);
+                            e[i + 1] = s * r;
+                            s = e[i] / r;
+                            c = p / r;
+                            p = c * d[i] - s * g;
+                            d[i + 1] = h + s * (c * g + s * d[i]);
+
+                            double* row_i = vt.data() + i * n;
+                            double* row_next = row_i + n;
+                            for (std::size_t k = 0; k < n; ++k) {
+                                const double next = row_next[k];
+                                row_next[k] = s * row_i[k] + c * next;
+                                row_i[k] = c * row_i[k] - s * next;
+                            }
+                        }
+                        p = -s * s2 * c3 * el1 * e[l] / dl1;
+                        e[l] = s * p;
+                        d[l] = c * p;
+                    } while (std::abs(e[l]) > eps * tst1);
+                }
+                d[l] += f;
+                e[l] = 0.0;
+            }
+        }
+
+    } // namespace
+
+
+    // PROJECTION INTERFACE --------------------------------------------------------------------------------------------
+
+    void ProjectionInterface::project(const std::span<const float> embedding, const std::span<float> out) const {
+        project(MatrixView{embedding.data(), 1, embedding.size(), embedding.size()}, out);
+    }
+
+    std::vector<float> ProjectionInterface::project(const std::span<const float> embedding) const {
+        std::vector<float> out(output_dimension());
+        project(embedding, out);
+        return out;
+    }
+
+    double ProjectionInterface::recall_at_k(
+        const MatrixView& corpus,
+        const MatrixView& queries,
+        const std::size_t k,
+        const std::size_t num_threads
+    ) const {
+        if (corpus.rows == 0 || queries.rows == 0 || k == 0) return 0.0;
+
+        std::vector<float> projected_corpus(corpus.rows * output_dimension());
+        std::vector<float> projected_queries(queries.rows * output_dimension());
+        project(corpus, projected_corpus);
+        project(queries, projected_queries);
+        const MatrixView reduced{projected_corpus.data(), corpus.rows, output_dimension(), output_dimension()};
+
+        const std::size_t threads = resolve_threads(num_threads, queries.rows);
+        std::vector<std::size_t> hits(threads, 0);
+
+        run_workers(threads, [&](const std::size_t worker) {
+            std::unordered_set<std::size_t> exact;
+            for (std::size_t q = worker; q < queries.rows; q += threads) {
+                exact.clear();
+                for (const auto& [row, score] : VectorMaths::top_k_cosine(corpus, queries.row(q), k)) exact.insert(row);
+
+                const std::span<const float> query(projected_queries.data() + q * output_dimension(), output_dimension());
+                for (const auto& [row, score] : VectorMaths::top_k_cosine(reduced, query, k)) hits[worker] += exact.count(row);
+            }
+        });
+
+        const double total_hits = static_cast<double>(std::accumulate(hits.begin(), hits.end(), std::size_t{0}));
+        return total_hits / static_cast<double>(queries.rows * std::min(k, corpus.rows));
+    }
+
+
+    // MATRYOSHKA TRUNCATION -------------------------------------------------------------------------------------------
+
+    MatryoshkaTruncation::MatryoshkaTruncation(
+        const std::size_t input_dimension,
+        const std::size_t output_dimension,
+        const bool renormalise
+    ) :
+        input_dimension_(input_dimension),
+        output_dimension_(output_dimension),
+        renormalise_(renormalise)
+    {
+        if (output_dimension == 0 || output_dimension > input_dimension) {
+            throw std::invalid_argument("Truncated dimension must be between 1 and the input dimension.");
+        }
+    }
+
+    void MatryoshkaTruncation::project(const MatrixView& embeddings, const std::span<float> out) const {
+        check_projection_buffers(embeddings, out, input_dimension_, output_dimension_);
+
+        for (std::size_t row = 0; row < embeddings.rows; ++row) {
+            const auto target = out.subspan(row * output_dimension_, output_dimension_);
+            std::copy_n(embeddings.row(row).begin(), output_dimension_, target.begin());
+            if (renormalise_) normalise_inplace(target);
+        }
+    }
+
+
+    // PCA PROJECTION --------------------------------------------------------------------------------------------------
+
+    PcaProjection::PcaProjection(const MatrixView& sample, const PcaConfig& config) :
+        input_dimension_(sample.cols),
+        output_dimension_(config.output_dimension),
+        renormalise_(config.renormalise)
+    {
+        const std::size_t n = sample.rows;
+        const std::size_t dim = sample.cols;
+        if (n < 2) throw std::invalid_argument("PCA needs a sample of at least two embeddings.");
+        if (output_dimension_ == 0 || output_dimension_ > dim) {
+            throw std::invalid_argument("PCA output dimension must be between 1 and the embedding dimension.");
+        }
+
+        std::vector<double> mean(dim, 0.0);
+        for (std::size_t row = 0; row < n; ++row) {
+            const auto values = sample.row(row);
+            for (std::size_t j = 0; j < dim; ++j) mean[j] += values[j];
+        }
+        for (double& val : mean) val /= static_cast<double>(n);
+
+        // Upper triangle of the covariance. Threads own interleaved output rows, which balances the triangle and
+        // lets each thread accumulate in place without a private copy of the matrix.
+        std::vector<double> covariance(dim * dim, 0.0);
+        const std::size_t threads = resolve_threads(config.num_threads, dim);
+        run_workers(threads, [&](const std::size_t worker) {
+            std::vector<double> centred(dim);
+            for (std::size_t row = 0; row < n; ++row) {
+                const auto values = sample.row(row);
+                for (std::size_t j = 0; j < dim; ++j) centred[j] = values[j] - mean[j];
+
+                for (std::size_t i = worker; i < dim; i += threads) {
+                    const double scale = centred[i];
+                    double* target = covariance.data() + i * dim;
+                    for (std::size_t j = i; j < dim; ++j) target[j] += scale * centred[j];
+                }
+            }
+        });
+
+        const double denominator = static_cast<double>(n - 1);
+        for (std::size_t i = 0; i < dim; ++i) {
+            for (std::size_t j = i; j < dim; ++j) {
+                covariance[i * dim + j] /= denominator;
+                covariance[j * dim + i] = covariance[i * dim + j];
+            }
+        }
+
+        std::vector<double> eigenvalues(dim);
+        std::vector<double> off_diagonal(dim);
+        std::vector<double>& eigenvectors = covariance;
+        tridiagonalise(eigenvectors, eigenvalues, off_diagonal, dim);
+        diagonalise(eigenvectors, eigenvalues, off_diagonal, dim);
+
+        std::vector<std::size_t> order(dim);
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::stable_sort(order, [&eigenvalues](const std::size_t a, const std::size_t b) {
+            return eigenvalues[a] > eigenvalues[b];
+        });
+
+        mean_.assign(mean.begin(), mean.end());
+        components_.resize(output_dimension_ * dim);
+        explained_variance_.resize(output_dimension_);
+
+        for (std::size_t c = 0; c < output_dimension_; ++c) {
+            const double* vector = eigenvectors.data() + order[c] * dim;
+
+            // Eigenvectors are only defined up to sign. Making the largest entry positive keeps fits reproducible.
+            const std::size_t largest = static_cast<std::size_t>(
+                std::max_element(vector, vector + dim, [](const double a, const double b) { return std::abs(a) < std::abs(b); }) - vector
+            );
+            const double sign = vector[largest] < 0 ? -1.0 : 1.0;
+
+            for (std::size_t j = 0; j < dim; ++j) components_[c * dim + j] = static_cast<float>(sign * vector[j]);
+            explained_variance_[c] = static_cast<float>(std::max(eigenvalues[order[c]], 0.0));
+        }
+
+        compute_offsets();
+    }
+
+    PcaProjection::PcaProjection(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("Unable to open PCA projection: " + path);
+
+        PcaFileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file || std::memcmp(header.magic, pca_magic, sizeof(pca_magic)) != 0 || header.version != pca_version) {
+            throw std::runtime_error("Not a PCA projection: '" + path + "'");
+        }
+        if (header.output_dimension == 0 || header.output_dimension > header.input_dimension) {
+            throw std::runtime_error("Invalid dimensions in PCA projection '" + path + "'");
+        }
+
+        input_dimension_ = header.input_dimension;
+        output_dimension_ = header.output_dimension;
+        renormalise_ = header.renormalise != 0;
+        mean_.resize(input_dimension_);
+        explained_variance_.resize(output_dimension_);
+        components_.resize(output_dimension_ * input_dimension_);
+
+        for (std::vector<float>* block : {&mean_, &explained_variance_, &components_}) {
+            file.read(reinterpret_cast<char*>(block->data()), static_cast<std::streamsize>(block->size() * sizeof(float)));
+        }
+        if (!file) throw std::runtime_error("Truncated PCA projection: '" + path + "'");
+
+        compute_offsets();
+    }
+
+    void PcaProjection::save(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) throw std::runtime_error("Unable to create PCA projection: " + path);
+
+        PcaFileHeader header{};
+        std::memcpy(header.magic, pca_magic, sizeof(pca_magic));
+        header.version = pca_version;
+        header.renormalise = renormalise_ ? 1 : 0;
+        header.input_dimension = input_dimension_;
+        header.output_dimension = output_dimension_;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const std::vector<float>* block : {&mean_, &explained_variance_, &components_}) {
+            file.write(reinterpret_cast<const char*>(block->data()), static_cast<std::streamsize>(block->size() * sizeof(float)));
+        }
+        if (!file.flush()) throw std::runtime_error("Unable to write PCA projection: " + path);
+    }
+
+    void PcaProjection::project(const MatrixView& embeddings, const std::span<float> out) const {
+        check_projection_buffers(embeddings, out, input_dimension_, output_dimension_);
+
+        // A blocked GEMM, out = X W^T - offsets, built from SIMD dot products. Each block of input rows stays in
+        // cache while every component is applied to it.
+        for (std::size_t block = 0; block < embeddings.rows; block += project_block_rows) {
+            const std::size_t block_end = std::min(embeddings.rows, block + project_block_rows);
+            for (std::size_t c = 0; c < output_dimension_; ++c) {
+                const std::span<const float> component(components_.data() + c * input_dimension_, input_dimension_);
+                for (std::size_t row = block; row < block_end; ++row) {
+                    out[row * output_dimension_ + c] = VectorMaths::dot_product(embeddings.row(row), component) - offsets_[c];
+                }
+            }
+            if (renormalise_) {
+                for (std::size_t row = block; row < block_end; ++row) {
+                    normalise_inplace(out.subspan(row * output_dimension_, output_dimension_));
+                }
+            }
+        }
+    }
+
+
+    // PRIVATE METHODS -------------------------------------------------------------------------------------------------
+
+    void PcaProjection::compute_offsets() {
+        offsets_.resize(output_dimension_);
+        for (std::size_t c = 0; c < output_dimension_; ++c) {
+            const std::span<const float> component(components_.data() + c * input_dimension_, input_dimension_);
+            offsets_[c] = VectorMaths::dot_product(component, mean_);
+        }
+    }
+
+} // namespace sentencpp::embedding_utils
@@ -0,0 +1,304 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sentenCPP/embedding_utils/EmbeddingStore.h>
+
+namespace sentencpp::embedding_utils {
+
+    namespace {
+
+        constexpr char store_magic[8] = {'S', 'C', 'P', 'P', 'E', 'M', 'B', 'D'};
+        constexpr uint32_t store_version = 1;
+        constexpr std::size_t header_size = 4096;
+        constexpr std::size_t row_alignment = 64;
+        constexpr std::size_t fingerprint_size = 64;
+
+        struct FileHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t dtype;
+            uint64_t dimension;
+            uint64_t row_stride;  // In bytes.
+            uint64_t row_count;   // Rows published by the last flush.
+            char model_fingerprint[fingerprint_size];
+        };
+
+        static_assert(sizeof(FileHeader) <= header_size);
+
+        [[noreturn]] void throw_io_error(const std::string& what, const std::string& path) {
+            throw std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+        }
+
+        void write_all(const int fd, const void* data, std::size_t length, off_t offset, const char* what) {
+            const auto* bytes = static_cast<const char*>(data);
+            while (length > 0) {
+                const ssize_t written = ::pwrite(fd, bytes, length, offset);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+                }
+                bytes += written;
+                length -= static_cast<std::size_t>(written);
+                offset += written;
+            }
+        }
+
+        bool read_header(const int fd, FileHeader& header) {
+            return ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                std::memcmp(header.magic, store_magic, sizeof(store_magic)) == 0 &&
+                header.version == store_version;
+        }
+
+        std::string_view header_fingerprint(const FileHeader& header) {
+            return {header.model_fingerprint, strnlen(header.model_fingerprint, fingerprint_size)};
+        }
+
+    } // namespace
+
+
+    // WRITER ----------------------------------------------------------------------------------------------------------
+
+    EmbeddingStoreWriter::EmbeddingStoreWriter(
+        const std::string& path,
+        const std::size_t dimension,
+        const std::string_view model_fingerprint
+    ) :
+        dimension_(dimension),
+        row_stride_((dimension * sizeof(float) + row_alignment - 1) / row_alignment * row_alignment)
+    {
+        if (dimension == 0) throw std::invalid_argument("Embedding dimension must be greater than zero.");
+        if (model_fingerprint.size() > fingerprint_size) {
+            throw std::invalid_argument("Model fingerprint must be at most 64 bytes.");
+        }
+
+        data_fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (data_fd_ < 0) throw_io_error("Unable to open embedding store", path);
+        ids_fd_ = ::open((path + ".ids").c_str(), O_RDWR | O_CREAT, 0644);
+        if (ids_fd_ < 0) {
+            close_files();
+            throw_io_error("Unable to open embedding store ids", path + ".ids");
+        }
+
+        struct stat info{};
+        if (::fstat(data_fd_, &info) != 0) {
+            close_files();
+            throw_io_error("Unable to stat embedding store", path);
+        }
+
+        if (info.st_size == 0) {
+            FileHeader header{};
+            std::memcpy(header.magic, store_magic, sizeof(store_magic));
+            header.version = store_version;
+            header.dtype = static_cast<uint32_t>(EmbeddingDType::Float32);
+            header.dimension = dimension_;
+            header.row_stride = row_stride_;
+            header.row_count = 0;
+            std::memcpy(header.model_fingerprint, model_fingerprint.data(), model_fingerprint.size());
+
+            std::vector<char> block(header_size, 0);
+            std::memcpy(block.data(), &header, sizeof(header));
+            try {
+                write_all(data_fd_, block.data(), block.size(), 0, "Unable to write embedding store header");
+            } catch (...) {
+                close_files();
+                throw;
+            }
+            return;
+        }
+
+        FileHeader header{};
+        if (!read_header(data_fd_, header)) {
+            close_files();
+            throw std::runtime_error("Not an embedding store: '" + path + "'");
+        }
+        if (header.dimension != dimension_ || header_fingerprint(header) != model_fingerprint) {
+            close_files();
+            throw std::runtime_error("Embedding store '" + path + "' was written with a different model or dimension.");
+        }
+        if (header.dtype != static_cast<uint32_t>(EmbeddingDType::Float32) || header.row_stride != row_stride_) {
+            close_files();
+            throw std::runtime_error("Embedding store '" + path + "' has a row layout this writer does not produce.");
+        }
+
+        // Resume after the last published row. Unpublished rows are overwritten.
+        next_row_ = header.row_count;
+    }
+
+    EmbeddingStoreWriter::~EmbeddingStoreWriter() {
+        try {
+            flush();
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Failed to flush embedding store: " << e.what() << std::endl;
+        }
+        close_files();
+    }
+
+    std::size_t EmbeddingStoreWriter::append(const std::span<const uint64_t> ids, const std::span<const float> embeddings) {
+        const std::size_t count = ids.size();
+        if (embeddings.size() != count * dimension_) {
+            throw std::invalid_argument("Embeddings must hold ids.size() * dimension floats.");
+        }
+        if (count == 0) return next_row_.load();
+
+        std::shared_lock lock(commit_mutex_);
+        if (failed_) throw std::runtime_error("Embedding store is unusable after a failed append.");
+        const std::size_t first_row = next_row_.fetch_add(count);
+
+        // The rows are claimed before they are written, so a failed write leaves a gap that flush must not publish.
+        try {
+            write_rows(first_row, ids, embeddings);
+        } catch (...) {
+            failed_ = true;
+            throw;
+        }
+        return first_row;
+    }
+
+    std::size_t EmbeddingStoreWriter::append(const uint64_t id, const std::span<const float> embedding) {
+        return append(std::span<const uint64_t>(&id, 1), embedding);
+    }
+
+    void EmbeddingStoreWriter::flush() {
+        std::unique_lock lock(commit_mutex_);
+        if (data_fd_ < 0) return;
+        if (failed_) throw std::runtime_error("Embedding store has a failed append; refusing to publish its rows.");
+
+        // Data must be durable before the row count that makes it visible.
+        if (::fsync(data_fd_) != 0 || ::fsync(ids_fd_) != 0) {
+            throw std::runtime_error(std::string("Unable to sync embedding store: ") + std::strerror(errno));
+        }
+
+        const uint64_t row_count = next_row_.load();
+        write_all(data_fd_, &row_count, sizeof(row_count), offsetof(FileHeader, row_count), "Unable to update row count");
+        if (::fsync(data_fd_) != 0) {
+            throw std::runtime_error(std::string("Unable to sync embedding store header: ") + std::strerror(errno));
+        }
+    }
+
+    void EmbeddingStoreWriter::write_rows(
+        const std::size_t first_row,
+        const std::span<const uint64_t> ids,
+        const std::span<const float> embeddings
+    ) const {
+        const std::size_t count = ids.size();
+        const auto data_offset = static_cast<off_t>(header_size + first_row * row_stride_);
+
+        if (row_stride_ == dimension_ * sizeof(float)) {
+            // Rows are already aligned, so the caller's buffer can be written as is.
+            write_all(data_fd_, embeddings.data(), embeddings.size_bytes(), data_offset, "Unable to append embeddings");
+        } else {
+            std::vector<char> padded(count * row_stride_, 0);
+            for (std::size_t i = 0; i < count; ++i) {
+                std::memcpy(padded.data() + i * row_stride_, embeddings.data() + i * dimension_, dimension_ * sizeof(float));
+            }
+            write_all(data_fd_, padded.data(), padded.size(), data_offset, "Unable to append embeddings");
+        }
+
+        const auto ids_offset = static_cast<off_t>(first_row * sizeof(uint64_t));
+        write_all(ids_fd_, ids.data(), ids.size_bytes(), ids_offset, "Unable to append embedding ids");
+    }
+
+    void EmbeddingStoreWriter::close_files() noexcept {
+        if (data_fd_ >= 0) ::close(data_fd_);
+        if (ids_fd_ >= 0) ::close(ids_fd_);
+        data_fd_ = ids_fd_ = -1;
+    }
+
+
+    // READER ----------------------------------------------------------------------------------------------------------
+
+    EmbeddingStoreReader::EmbeddingStoreReader(const std::string& path) {
+        const int data_fd = ::open(path.c_str(), O_RDONLY);
+        if (data_fd < 0) throw_io_error("Unable to open embedding store", path);
+
+        FileHeader header{};
+        if (!read_header(data_fd, header)) {
+            ::close(data_fd);
+            throw std::runtime_error("Not an embedding store: '" + path + "'");
+        }
+        if (header.dtype != static_cast<uint32_t>(EmbeddingDType::Float32)) {
+            ::close(data_fd);
+            throw std::runtime_error("Unsupported embedding dtype in '" + path + "'");
+        }
+
+        rows_ = header.row_count;
+        dimension_ = header.dimension;
+        row_stride_ = header.row_stride;
+        model_fingerprint_ = header_fingerprint(header);
+
+        if (dimension_ == 0 || row_stride_ % sizeof(float) != 0 || dimension_ > row_stride_ / sizeof(float)) {
+            ::close(data_fd);
+            throw std::runtime_error("Invalid row layout in embedding store '" + path + "'");
+        }
+
+        // Mapping past the end of a truncated file would fault on first access, so check the header against it.
+        struct stat info{};
+        if (::fstat(data_fd, &info) != 0) {
+            ::close(data_fd);
+            throw_io_error("Unable to stat embedding store", path);
+        }
+        const auto data_size = static_cast<std::size_t>(info.st_size);
+        if (data_size < header_size || (data_size - header_size) / row_stride_ < rows_) {
+            ::close(data_fd);
+            throw std::runtime_error("Embedding store '" + path + "' is shorter than its header says.");
+        }
+
+        data_map_length_ = header_size + rows_ * row_stride_;
+        data_map_ = ::mmap(nullptr, data_map_length_, PROT_READ, MAP_SHARED, data_fd, 0);
+        ::close(data_fd);
+        if (data_map_ == MAP_FAILED) {
+            data_map_ = nullptr;
+            throw_io_error("Unable to map embedding store", path);
+        }
+        rows_data_ = reinterpret_cast<const float*>(static_cast<const char*>(data_map_) + header_size);
+
+        if (rows_ == 0) return;
+
+        const int ids_fd = ::open((path + ".ids").c_str(), O_RDONLY);
+        if (ids_fd < 0) {
+            unmap();
+            throw_io_error("Unable to open embedding store ids", path + ".ids");
+        }
+        if (::fstat(ids_fd, &info) != 0) {
+            ::close(ids_fd);
+            unmap();
+            throw_io_error("Unable to stat embedding store ids", path + ".ids");
+        }
+        if (static_cast<std::size_t>(info.st_size) / sizeof(uint64_t) < rows_) {
+            ::close(ids_fd);
+            unmap();
+            throw std::runtime_error("Embedding store ids '" + path + ".ids' are shorter than the store.");
+        }
+        ids_map_length_ = rows_ * sizeof(uint64_t);
+        ids_map_ = ::mmap(nullptr, ids_map_length_, PROT_READ, MAP_SHARED, ids_fd, 0);
+        ::close(ids_fd);
+        if (ids_map_ == MAP_FAILED) {
+            ids_map_ = nullptr;
+            unmap();
+            throw_io_error("Unable to map embedding store ids", path + ".ids");
+        }
+        ids_ = static_cast<const uint64_t*>(ids_map_);
+    }
+
+    EmbeddingStoreReader::~EmbeddingStoreReader() {
+        unmap();
+    }
+
+    MatrixView EmbeddingStoreReader::matrix() const {
+        return MatrixView{rows_data_, rows_, dimension_, row_stride_ / sizeof(float)};
+    }
+
+    void EmbeddingStoreReader::unmap() noexcept {
+        if (data_map_ != nullptr) ::munmap(data_map_, data_map_length_);
+        if (ids_map_ != nullptr) ::munmap(ids_map_, ids_map_length_);
+        data_map_ = ids_map_ = nullptr;
+    }
+
+} // namespace sentencpp::embedding_utils
@@ -0,0 +1,132 @@
+#include <stdexcept>
+#include <sentenCPP/inference/ModelRegistry.h>
+#include "BatchEncoding.h"
+
+namespace sentencpp::inference {
+
+    // MODEL BUNDLE ----------------------------------------------------------------------------------------------------
+
+    ModelBundle::ModelBundle(const ModelBundleConfig& config, const uint64_t version) :
+        version_(version),
+        fingerprint_(config.fingerprint.empty() ? config.model.model_path : config.fingerprint),
+        tokenizer_(config.tokenizer),
+        engine_(std::make_unique<OnnxEngine>(config.model))
+    {}
+
+    void ModelBundle::warm_up(const std::vector<std::string>& texts) const {
+        if (texts.empty()) return;
+
+        std::vector<int64_t> input_ids;
+        std::vector<int64_t> attention_mask;
+        std::vector<int64_t> segment_ids;
+        tokenizer::TokenizerScratch scratch;
+
+        const BatchInputs inputs = detail::encode_batch(texts.size(), tokenizer_.get_config().max_length, input_ids,
+            attention_mask, segment_ids, [&](const std::size_t row, const tokenizer::EncodingBuffers& out) {
+                return tokenizer_.tokenize(texts[row], scratch, out);
+            });
+        static_cast<void>(engine_->run(inputs));
+    }
+
+
+    // MODEL REGISTRY --------------------------------------------------------------------------------------------------
+
+    ModelRegistry::ModelRegistry(const ModelBundleConfig& config) {
+        current_.store(load(config));
+        worker_ = std::thread(&ModelRegistry::run_worker, this);
+    }
+
+    ModelRegistry::~ModelRegistry() {
+        {
+            std::lock_guard lock(state_->mutex);
+            state_->stopping = true;
+        }
+        state_->wake.notify_one();
+        worker_.join();
+    }
+
+    std::future<std::shared_ptr<const ModelBundle>> ModelRegistry::swap_async(const ModelBundleConfig& config) {
+        std::future<std::shared_ptr<const ModelBundle>> published;
+        {
+            std::lock_guard lock(state_->mutex);
+            if (state_->stopping) throw std::runtime_error("Model registry is shutting down.");
+            published = state_->requests.emplace_back(SwapRequest{config, {}}).published.get_future();
+        }
+        state_->wake.notify_one();
+        return published;
+    }
+
+    std::shared_ptr<const ModelBundle> ModelRegistry::swap(const ModelBundleConfig& config) {
+        return swap_async(config).get();
+    }
+
+
+    // PRIVATE METHODS -------------------------------------------------------------------------------------------------
+
+    void ModelRegistry::run_worker() {
+        WorkerState& state = *state_;
+        std::unique_lock lock(state.mutex);
+        while (true) {
+            state.wake.wait(lock, [&] { return state.stopping || !state.requests.empty() || !state.released.empty(); });
+
+            if (!state.released.empty()) {
+                std::vector<const ModelBundle*> released;
+                released.swap(state.released);
+                lock.unlock();
+                for (const ModelBundle* bundle : released) delete bundle;
+                lock.lock();
+                continue;
+            }
+
+            if (state.stopping) {
+                for (auto& request : state.requests) {
+                    request.published.set_exception(std::make_exception_ptr(
+                        std::runtime_error("Model registry shut down before the swap was applied.")
+                    ));
+                }
+                state.requests.clear();
+                return;
+            }
+
+            SwapRequest request = std::move(state.requests.front());
+            state.requests.pop_front();
+            lock.unlock();
+
+            // Loading and warming up happen while the previous version keeps serving.
+            std::shared_ptr<const ModelBundle> bundle;
+            try {
+                bundle = load(request.config);
+            } catch (...) {
+                request.published.set_exception(std::current_exception());
+                lock.lock();
+                continue;
+            }
+
+            std::shared_ptr<const ModelBundle> previous = current_.exchange(bundle);
+            request.published.set_value(std::move(bundle));
+            // Released without the lock: if no request holds the previous version, its deleter queues it right away.
+            previous.reset();
+            lock.lock();
+        }
+    }
+
+    std::shared_ptr<const ModelBundle> ModelRegistry::load(const ModelBundleConfig& config) {
+        auto bundle = std::make_unique<const ModelBundle>(config, next_version_++);
+        bundle->warm_up(config.warmup_texts);
+
+        // Whichever thread drops the last reference, usually a request finishing on the old version, only queues the
+        // bundle for the worker to destroy. Once the registry is stopping there is no worker, so it is destroyed here.
+        return std::shared_ptr<const ModelBundle>(bundle.release(), [state = state_](const ModelBundle* released) {
+            {
+                std::lock_guard lock(state->mutex);
+                if (!state->stopping) {
+                    state->released.push_back(released);
+                    state->wake.notify_one();
+                    return;
+                }
+            }
+            delete released;
+        });
+    }
+
+} // namespace sentencpp::inference
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <sentenCPP/embedding_utils/NearDuplicates.h>
+#include "Workers.h"
+
+namespace sentencpp::embedding_utils {
+
+    using detail::resolve_threads;
+    using detail::run_workers;
+
+    namespace {
+
+        struct ContiguousRows {
+            std::vector<float> data;
+            MatrixView view;
+        };
+
+        ContiguousRows pack_rows(const std::vector<std::vector<float>>& embeddings) {
+            ContiguousRows packed;
+            const std::size_t cols = embeddings.empty() ? 0 : embeddings[0].size();
+            packed.data.reserve(embeddings.size() * cols);
+            for (const auto& row : embeddings) {
+                if (row.size() != cols) throw std::invalid_argument("All embeddings must have the same dimension.");
+                packed.data.insert(packed.data.end(), row.begin(), row.end());
+            }
+            packed.view = MatrixView{packed.data.data(), embeddings.size(), cols, cols};
+            return packed;
+        }
+
+    } // namespace
+
+    NearDuplicateDetector::NearDuplicateDetector(const std::size_t dimension, const NearDuplicateConfig& config) :
+        config_(config),
+        dimension_(dimension),
+        signature_bits_(config.bands * config.rows_per_band),
+        signature_words_((signature_bits_ + 63) / 64)
+    {
+        if (dimension == 0) throw std::invalid_argument("Embedding dimension must be greater than zero.");
+        if (config.bands == 0 || config.rows_per_band == 0 || config.rows_per_band > 64) {
+            throw std::invalid_argument("bands must be non-zero and rows_per_band must be between 1 and 64.");
+        }
+
+        std::mt19937_64 rng(config.seed);
+        std::normal_distribution<float> normal(0.0f, 1.0f);
+        hyperplanes_.resize(signature_bits_ * dimension_);
+        for (float& value : hyperplanes_) value = normal(rng);
+    }
+
+
+    // PUBLIC METHODS --------------------------------------------------------------------------------------------------
+
+    void NearDuplicateDetector::signature(const std::span<const float> embedding, const std::span<uint64_t> out) const {
+        if (embedding.size() != dimension_ || out.size() < signature_words_) {
+            throw std::invalid_argument("Embedding or signature buffer has the wrong size.");
+        }
+
+        std::fill_n(out.begin(), signature_words_, 0);
+        for (std::size_t bit = 0; bit < signature_bits_; ++bit) {
+            const std::span<const float> plane(hyperplanes_.data() + bit * dimension_, dimension_);
+            if (VectorMaths::dot_product(embedding, plane) >= 0.0f) out[bit / 64] |= uint64_t{1} << (bit % 64);
+        }
+    }
+
+    std::vector<DuplicatePair> NearDuplicateDetector::find_pairs(const MatrixView& embeddings) const {
+        const std::size_t n = embeddings.rows;
+        std::vector<uint64_t> signatures;
+        std::vector<float> inverse_norms;
+        compute_signatures(embeddings, signatures, inverse_norms);
+        if (n < 2) return {};
+        const auto cosine = [&](const std::size_t a, const std::size_t b) {
+            const float dot = VectorMaths::dot_product(embeddings.row(a), embeddings.row(b));
+            return dot * inverse_norms[a] * inverse_norms[b];
+        };
+
+        // Bands are independent, so each worker takes the next unclaimed band until none are left and collects the
+        // candidate pairs it sees as (first << 32 | second) keys. A pair that collides in several bands is verified
+        // once, after the keys are merged.
+        const std::size_t threads = resolve_threads(config_.num_threads, config_.bands);
+        std::vector<std::vector<uint64_t>> found_keys(threads);
+        std::atomic<std::size_t> next_band = 0;
+
+        run_workers(threads, [&](const std::size_t worker) {
+            std::vector<std::pair<uint64_t, uint32_t>> buckets(n);
+            auto& keys = found_keys[worker];
+
+            for (std::size_t band = next_band++; band < config_.bands; band = next_band++) {
+                const auto band_begin = static_cast<std::ptrdiff_t>(keys.size());
+                sort_band(signatures, band, buckets);
+                for (std::size_t begin = 0, end; begin < n; begin = end) {
+                    for (end = begin + 1; end < n && buckets[end].first == buckets[begin].first; ++end) {}
+
+                    // Rows within a bucket are ascending, so every key has first < second.
+                    const std::size_t cap = config_.max_bucket_size;
+                    const std::size_t last = cap > 0 ? std::min(end, begin + cap) : end;
+                    for (std::size_t x = begin; x + 1 < last; ++x) {
+                        const uint64_t first = uint64_t{buckets[x].second} << 32;
+                        for (std::size_t y = x + 1; y < last; ++y) keys.push_back(first | buckets[y].second);
+                    }
+                }
+                // Merging each band in keeps a pair that collides in many bands down to one key.
+                std::sort(keys.begin() + band_begin, keys.end());
+                std::inplace_merge(keys.begin(), keys.begin() + band_begin, keys.end());
+                keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            }
+        });
+
+        std::vector<uint64_t> candidates;
+        for (auto& keys : found_keys) {
+            candidates.insert(candidates.end(), keys.begin(), keys.end());
+            std::vector<uint64_t>().swap(keys);
+        }
+        std::ranges::sort(candidates);
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        // Candidates are sorted, so verifying contiguous chunks and concatenating keeps pairs ordered.
+        const std::size_t verify_threads = resolve_threads(config_.num_threads, candidates.size());
+        const std::size_t chunk = (candidates.size() + verify_threads - 1) / verify_threads;
+        std::vector<std::vector<DuplicatePair>> found(verify_threads);
+        run_workers(verify_threads, [&](const std::size_t worker) {
+            const std::size_t end = std::min(candidates.size(), (worker + 1) * chunk);
+            for (std::size_t i = worker * chunk; i < end; ++i) {
+                const std::size_t a = candidates[i] >> 32;
+                const std::size_t b = candidates[i] & 0xffffffff;
+                const float similarity = cosine(a, b);
+                if (similarity >= config_.threshold) found[worker].push_back(DuplicatePair{a, b, similarity});
+            }
+        });
+
+        std::vector<DuplicatePair> pairs;
+        for (auto& worker_pairs : found) pairs.insert(pairs.end(), worker_pairs.begin(), worker_pairs.end());
+        return pairs;
+    }
+
+    std::vector<DuplicatePair> NearDuplicateDetector::find_pairs(const std::vector<std::vector<float>>& embeddings) const {
+        const ContiguousRows packed = pack_rows(embeddings);
+        return find_pairs(packed.view);
+    }
+
+    std::vector<std::vector<std::size_t>> NearDuplicateDetector::find_clusters(const MatrixView& embeddings) const {
+        const std::size_t n = embeddings.rows;
+        std::vector<uint64_t> signatures;
+        std::vector<float> inverse_norms;
+        compute_signatures(embeddings, signatures, inverse_norms);
+        const auto cosine = [&](const std::size_t a, const std::size_t b) {
+            const float dot = VectorMaths::dot_product(embeddings.row(a), embeddings.row(b));
+            return dot * inverse_norms[a] * inverse_norms[b];
+        };
+
+        // Union-find with path halving; the smaller row always becomes the root.
+        std::vector<std::size_t> parent(n);
+        std::iota(parent.begin(), parent.end(), 0);
+        auto root = [&parent](std::size_t i) {
+            while (parent[i] != i) i = parent[i] = parent[parent[i]];
+            return i;
+        };
+
+        // Rather than verifying every pair in a bucket, each row is compared with the representatives of the groups
+        // already formed in that bucket and joins the first it duplicates, or starts a new group. Rows already in the
+        // same cluster are not compared again, so k near-identical rows cost O(k) per band instead of O(k^2).
+        // Bands are sorted in parallel, a batch at a time, and merged in order on the calling thread.
+        const std::size_t threads = resolve_threads(config_.num_threads, config_.bands);
+        std::vector<std::vector<std::pair<uint64_t, uint32_t>>> sorted(threads);
+        for (auto& buckets : sorted) buckets.resize(n);
+        std::vector<std::size_t> representatives;
+
+        for (std::size_t first_band = 0; first_band < config_.bands; first_band += threads) {
+            const std::size_t batch = std::min(threads, config_.bands - first_band);
+            run_workers(batch, [&](const std::size_t worker) {
+                sort_band(signatures, first_band + worker, sorted[worker]);
+            });
+
+            for (std::size_t w = 0; w < batch; ++w) {
+                const auto& buckets = sorted[w];
+                for (std::size_t begin = 0, end; begin < n; begin = end) {
+                    for (end = begin + 1; end < n && buckets[end].first == buckets[begin].first; ++end) {}
+                    if (end - begin < 2) continue;
+
+                    representatives.clear();
+                    for (std::size_t x = begin; x < end; ++x) {
+                        const std::size_t row = buckets[x].second;
+                        bool joined = false;
+                        for (const std::size_t representative : representatives) {
+                            const std::size_t a = root(row);
+                            const std::size_t b = root(representative);
+                            if (a != b) {
+                                if (cosine(row, representative) < config_.threshold) continue;
+                                parent[std::max(a, b)] = std::min(a, b);
+                            }
+                            joined = true;
+                            break;
+                        }
+                        if (!joined) representatives.push_back(row);
+                    }
+                }
+            }
+        }
+
+        std::vector<std::size_t> cluster_size(n, 0);
+        for (std::size_t i = 0; i < n; ++i) cluster_size[root(i)]++;
+
+        // Roots are the smallest row of their cluster, so clusters come out ordered by first row.
+        std::vector<std::size_t> cluster_of(n);
+        std::vector<std::vector<std::size_t>> clusters;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t r = root(i);
+            if (cluster_size[r] < 2) continue;
+            if (r == i) {
+                cluster_of[r] = clusters.size();
+                clusters.emplace_back().reserve(cluster_size[r]);
+            }
+            clusters[cluster_of[r]].push_back(i);
+        }
+        return clusters;
+    }
+
+    std::vector<std::vector<std::size_t>> NearDuplicateDetector::find_clusters(
+        const std::vector<std::vector<float>>& embeddings
+    ) const {
+        const ContiguousRows packed = pack_rows(embeddings);
+        return find_clusters(packed.view);
+    }
+
+
+    // PRIVATE METHODS -------------------------------------------------------------------------------------------------
+
+    void NearDuplicateDetector::compute_signatures(
+        const MatrixView& embeddings,
+        std::vector<uint64_t>& signatures,
+        std::vector<float>& inverse_norms
+    ) const {
+        if (embeddings.rows > 0 && embeddings.cols != dimension_) {
+            throw std::invalid_argument("Embedding dimension does not match the detector.");
+        }
+        const std::size_t n = embeddings.rows;
+        signatures.assign(n * signature_words_, 0);
+        inverse_norms.assign(n, 0.0f);
+        if (n == 0) return;
+
+        const std::size_t threads = resolve_threads(config_.num_threads, n);
+        const std::size_t chunk = (n + threads - 1) / threads;
+        run_workers(threads, [&](const std::size_t worker) {
+            const std::size_t end = std::min(n, (worker + 1) * chunk);
+            for (std::size_t i = worker * chunk; i < end; ++i) {
+                const auto row = embeddings.row(i);
+                signature(row, std::span<uint64_t>(signatures.data() + i * signature_words_, signature_words_));
+                const float norm = std::sqrt(VectorMaths::dot_product(row, row));
+                inverse_norms[i] = norm > 0.0f ? 1.0f / norm : 0.0f;
+            }
+        });
+    }
+
+    void NearDuplicateDetector::sort_band(
+        const std::span<const uint64_t> signatures,
+        const std::size_t band,
+        std::vector<std::pair<uint64_t, uint32_t>>& buckets
+    ) const {
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            buckets[i] = {band_key(signatures.data() + i * signature_words_, band), static_cast<uint32_t>(i)};
+        }
+        std::ranges::sort(buckets);
+    }
+
+    uint64_t NearDuplicateDetector::band_key(const uint64_t* signature, const std::size_t band) const {
+        const std::size_t first_bit = band * config_.rows_per_band;
+        const std::size_t word = first_bit / 64;
+        const std::size_t shift = first_bit % 64;
+
+        uint64_t key = signature[word] >> shift;
+        if (shift + config_.rows_per_band > 64) key |= signature[word + 1] << (64 - shift);
+        return config_.rows_per_band == 64 ? key : key & ((uint64_t{1} << config_.rows_per_band) - 1);
+    }
+
+} // namespace sentencpp::embedding_utils
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <stdexcept>
 #include <sentencpp/tokenizer/TokenizerInterface.h>
 #include <sentencpp/inference/OnnxEngine.h>
 
@@ -14,7 +15,7 @@ namespace sentencpp::inference {
         memory_info(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
     {
         Ort::SessionOptions session_options;
-        session_options.SetIntraOpNumThreads(1);
+        session_options.SetIntraOpNumThreads(config.intra_op_threads);
         session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
 
         // Load model.
@@ -28,6 +29,9 @@ namespace sentencpp::inference {
         for (size_t i = 0; i < session.GetOutputCount(); i++) {
             output_names.emplace_back(session.GetOutputNameAllocated(i, allocator).get());
         }
+
+        // Fail at load time rather than on the first request.
+        static_cast<void>(find_output_index());
     }
 
 
@@ -49,52 +53,10 @@ namespace sentencpp::inference {
             segment_ids.push_back(t.segment_id);
         }
 
-        std::vector<Ort::Value> input_tensors;
-        std::vector<const char*> in_names;
-        const std::vector<int64_t> input_shape = {1, static_cast<int64_t>(sequence_length)};
-
-        for (const auto& name : input_names) {
-            in_names.push_back(name.c_str());
-            if (name == config_.input_ids_name) {
-                input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(
-                    memory_info, input_ids.data(), input_ids.size(), input_shape.data(), input_shape.size()
-                ));
-            } else if (name == config_.attention_mask_name) {
-                input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(
-                    memory_info, attention_mask.data(), attention_mask.size(), input_shape.data(), input_shape.size()
-                ));
-            } else if (name == config_.token_type_ids_name) {
-                input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(
-                    memory_info, segment_ids.data(), segment_ids.size(), input_shape.data(), input_shape.size()
-                ));
-            }
-        }
-
-        std::vector<const char*> out_names;
-        for (const auto& name : output_names) out_names.push_back(name.c_str());
-
-        auto output_tensors = session.Run(
-            Ort::RunOptions{nullptr},
-            in_names.data(),
-            input_tensors.data(),
-            input_tensors.size(),
-            out_names.data(),
-            out_names.size()
-        );
-
-        // Find the output data line.
-        size_t output_idx = -1;
-        for (size_t i = 0; i < output_names.size(); ++i) {
-            if (output_names[i] == config_.output_name) {
-                output_idx = i;
-                break;
-            }
-        }
-
-        if (output_idx == -1) {
-            std::cerr << "Unable to identify output line " << config_.output_name << std::endl;
-            exit(-1);
-        }
+        auto output_tensors = run_session(BatchInputs{
+            input_ids, attention_mask, segment_ids, 1, static_cast<int64_t>(sequence_length)
+        });
+        const size_t output_idx = find_output_index();
 
         // Parse Output.
         auto& output_tensor = output_tensors[output_idx];
@@ -123,7 +85,65 @@ namespace sentencpp::inference {
         return embeddings;
     }
 
+    TensorOutput OnnxEngine::run(const BatchInputs& inputs) {
+        if (inputs.batch_size == 0 || inputs.sequence_length == 0) return {};
+
+        auto output_tensors = run_session(inputs);
+        auto& output_tensor = output_tensors[find_output_index()];
+
+        const auto type_info = output_tensor.GetTensorTypeAndShapeInfo();
+        if (type_info.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+            throw std::runtime_error("Output '" + config_.output_name + "' is not a float tensor.");
+        }
+        const float* output_data = output_tensor.GetTensorMutableData<float>();
+        return TensorOutput{
+            std::vector<float>(output_data, output_data + type_info.GetElementCount()),
+            type_info.GetShape()
+        };
+    }
+
 
     // PRIVATE METHODS -------------------------------------------------------------------------------------------------
 
+    std::vector<Ort::Value> OnnxEngine::run_session(const BatchInputs& inputs) {
+        const size_t element_count = static_cast<size_t>(inputs.batch_size * inputs.sequence_length);
+        const std::vector<int64_t> input_shape = {inputs.batch_size, inputs.sequence_length};
+
+        std::vector<Ort::Value> input_tensors;
+        std::vector<const char*> in_names;
+
+        for (const auto& name : input_names) {
+            int64_t* data = nullptr;
+            if (name == config_.input_ids_name) data = inputs.input_ids.data();
+            else if (name == config_.attention_mask_name) data = inputs.attention_mask.data();
+            else if (name == config_.token_type_ids_name) data = inputs.segment_ids.data();
+            else continue;
+
+            in_names.push_back(name.c_str());
+            input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(
+                memory_info, data, element_count, input_shape.data(), input_shape.size()
+            ));
+        }
+
+        std::vector<const char*> out_names;
+        for (const auto& name : output_names) out_names.push_back(name.c_str());
+
+        return session.Run(
+            Ort::RunOptions{nullptr},
+            in_names.data(),
+            input_tensors.data(),
+            input_tensors.size(),
+            out_names.data(),
+            out_names.size()
+        );
+    }
+
+    size_t OnnxEngine::find_output_index() const {
+        for (size_t i = 0; i < output_names.size(); ++i) {
+            if (output_names[i] == config_.output_name) return i;
+        }
+
+        throw std::runtime_error("Model has no output named '" + config_.output_name + "'.");
+    }
+
 } // namespace sentencpp::inference
@@ -0,0 +1,237 @@
+#include <array>
+#include <bit>
+#include <map>
+#include <unicode/uchar.h>
+#include <unicode/utf8.h>
+#include <sentenCPP/tokenizer/PreTokenizer.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define SENTENCPP_PRETOKENIZER_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define SENTENCPP_PRETOKENIZER_NEON
+#endif
+
+namespace sentencpp::tokenizer {
+
+    namespace {
+
+        constexpr char32_t max_code_point = 0x10FFFF;
+        constexpr std::size_t block_bits = 8;
+        constexpr std::size_t block_size = std::size_t{1} << block_bits;
+        constexpr std::size_t block_count = (max_code_point + 1) >> block_bits;
+
+        // BERT treats every non-alphanumeric printable ASCII character as punctuation, even where Unicode calls it a
+        // symbol (eg: '$', '+', '^').
+        constexpr bool is_ascii_punctuation(const char32_t c) {
+            return (c >= 0x21 && c <= 0x2F) || (c >= 0x3A && c <= 0x40) || (c >= 0x5B && c <= 0x60) || (c >= 0x7B && c <= 0x7E);
+        }
+
+        constexpr bool is_ascii_whitespace(const char32_t c) {
+            return c == 0x20 || (c >= 0x09 && c <= 0x0D);
+        }
+
+        constexpr std::array<CharClass, 128> make_ascii_table() {
+            std::array<CharClass, 128> table{};
+            for (char32_t c = 0; c < 128; ++c) {
+                if (is_ascii_whitespace(c)) table[c] = CharClass::Whitespace;
+                else if (is_ascii_punctuation(c)) table[c] = CharClass::Punctuation;
+                else table[c] = CharClass::Word;
+            }
+            return table;
+        }
+
+        constexpr std::array<CharClass, 128> ascii_table = make_ascii_table();
+
+        // Two-stage lookup table covering every code point. The first stage maps the high bits of a code point to a
+        // block of 256 classes; identical blocks (most of the code space) are shared.
+        class CodePointTable {
+            public:
+                CodePointTable() {
+                    std::map<std::array<CharClass, block_size>, uint16_t> seen;
+                    std::array<CharClass, block_size> block{};
+
+                    for (std::size_t b = 0; b < block_count; ++b) {
+                        for (std::size_t i = 0; i < block_size; ++i) {
+                            block[i] = classify_icu(static_cast<UChar32>((b << block_bits) | i));
+                        }
+
+                        auto [it, inserted] = seen.try_emplace(block, static_cast<uint16_t>(seen.size()));
+                        if (inserted) blocks_.insert(blocks_.end(), block.begin(), block.end());
+                        index_[b] = it->second;
+                    }
+                }
+
+                [[nodiscard]] CharClass lookup(const char32_t c) const {
+                    return blocks_[(static_cast<std::size_t>(index_[c >> block_bits]) << block_bits) | (c & (block_size - 1))];
+                }
+
+            private:
+                std::array<uint16_t, block_count> index_{};
+                std::vector<CharClass> blocks_;
+
+                static CharClass classify_icu(const UChar32 c) {
+                    if (c < 128) return ascii_table[c];
+                    if (u_isUWhiteSpace(c)) return CharClass::Whitespace;
+                    if (U_GET_GC_MASK(c) & U_GC_P_MASK) return CharClass::Punctuation;
+                    return CharClass::Word;
+                }
+        };
+
+        const CodePointTable& code_point_table() {
+            static const CodePointTable table;
+            return table;
+        }
+
+        // Accumulates spans while the input is walked left to right.
+        struct SpanWriter {
+            std::vector<WordSpan>& spans;
+            uint32_t word_start = 0;
+            bool in_word = false;
+
+            void word(const uint32_t pos) {
+                if (in_word) return;
+                word_start = pos;
+                in_word = true;
+            }
+
+            void close(const uint32_t pos) {
+                if (!in_word) return;
+                spans.push_back(WordSpan{word_start, pos});
+                in_word = false;
+            }
+
+            void punctuation(const uint32_t begin, const uint32_t end) {
+                close(begin);
+                spans.push_back(WordSpan{begin, end});
+            }
+
+            // Consumes the classification bitmasks of a run of ASCII bytes starting at base. Only set bits in valid
+            // are considered. Work is proportional to the number of boundaries, not the number of bytes.
+            void ascii_run(const uint32_t base, const uint32_t whitespace, const uint32_t punctuation_mask, const uint32_t valid) {
+                const uint32_t delimiters = (whitespace | punctuation_mask) & valid;
+                const uint32_t words = valid & ~delimiters;
+                const uint32_t starts = words & ~((words << 1) | (in_word ? 1u : 0u));
+                uint32_t events = delimiters | starts;
+
+                while (events != 0) {
+                    const auto p = static_cast<uint32_t>(std::countr_zero(events));
+                    const uint32_t bit = 1u << p;
+                    events &= events - 1;
+
+                    if (starts & bit) word(base + p);
+                    else if (punctuation_mask & bit) punctuation(base + p, base + p + 1);
+                    else close(base + p);
+                }
+            }
+        };
+
+#if defined(SENTENCPP_PRETOKENIZER_SSE2)
+
+        constexpr std::size_t chunk_size = 16;
+
+        struct ChunkMasks {
+            uint32_t whitespace;
+            uint32_t punctuation;
+            uint32_t non_ascii;
+        };
+
+        // Signed comparisons are safe because bytes >= 0x80 are negative and fall outside every ASCII range.
+        inline __m128i in_range(const __m128i v, const char lo, const char hi) {
+            return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))), _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+        }
+
+        inline ChunkMasks classify_chunk(const uint8_t* data) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            const __m128i whitespace = _mm_or_si128(in_range(v, 0x09, 0x0D), _mm_cmpeq_epi8(v, _mm_set1_epi8(0x20)));
+            const __m128i punctuation = _mm_or_si128(
+                _mm_or_si128(in_range(v, 0x21, 0x2F), in_range(v, 0x3A, 0x40)),
+                _mm_or_si128(in_range(v, 0x5B, 0x60), in_range(v, 0x7B, 0x7E))
+            );
+            return ChunkMasks{
+                static_cast<uint32_t>(_mm_movemask_epi8(whitespace)),
+                static_cast<uint32_t>(_mm_movemask_epi8(punctuation)),
+                static_cast<uint32_t>(_mm_movemask_epi8(v))
+            };
+        }
+
+#elif defined(SENTENCPP_PRETOKENIZER_NEON)
+
+        constexpr std::size_t chunk_size = 16;
+
+        struct ChunkMasks {
+            uint32_t whitespace;
+            uint32_t punctuation;
+            uint32_t non_ascii;
+        };
+
+        inline uint8x16_t in_range(const uint8x16_t v, const uint8_t lo, const uint8_t hi) {
+            return vandq_u8(vcgeq_u8(v, vdupq_n_u8(lo)), vcleq_u8(v, vdupq_n_u8(hi)));
+        }
+
+        // NEON has no movemask, so weight each lane by its bit and sum the halves.
+        inline uint32_t movemask(const uint8x16_t m) {
+            static constexpr uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+            const uint8x16_t masked = vandq_u8(m, vld1q_u8(weights));
+            return static_cast<uint32_t>(vaddv_u8(vget_low_u8(masked))) | (static_cast<uint32_t>(vaddv_u8(vget_high_u8(masked))) << 8);
+        }
+
+        inline ChunkMasks classify_chunk(const uint8_t* data) {
+            const uint8x16_t v = vld1q_u8(data);
+            const uint8x16_t whitespace = vorrq_u8(in_range(v, 0x09, 0x0D), vceqq_u8(v, vdupq_n_u8(0x20)));
+            const uint8x16_t punctuation = vorrq_u8(
+                vorrq_u8(in_range(v, 0x21, 0x2F), in_range(v, 0x3A, 0x40)),
+                vorrq_u8(in_range(v, 0x5B, 0x60), in_range(v, 0x7B, 0x7E))
+            );
+            return ChunkMasks{movemask(whitespace), movemask(punctuation), movemask(vcgeq_u8(v, vdupq_n_u8(0x80)))};
+        }
+
+#endif
+
+    } // namespace
+
+
+    // PUBLIC METHODS --------------------------------------------------------------------------------------------------
+
+    void PreTokenizer::split(const std::string_view text, std::vector<WordSpan>& spans) {
+        spans.clear();
+        SpanWriter writer{spans};
+        const auto* data = reinterpret_cast<const uint8_t*>(text.data());
+        const auto n = static_cast<int32_t>(text.length());
+        int32_t i = 0;
+
+        while (i < n) {
+#if defined(SENTENCPP_PRETOKENIZER_SSE2) || defined(SENTENCPP_PRETOKENIZER_NEON)
+            // Classify 16 ASCII bytes at a time; stop at the first non-ASCII byte and decode it below.
+            if (static_cast<std::size_t>(n - i) >= chunk_size) {
+                const ChunkMasks masks = classify_chunk(data + i);
+                const auto ascii_bytes = static_cast<uint32_t>(masks.non_ascii == 0 ? chunk_size : std::countr_zero(masks.non_ascii));
+
+                writer.ascii_run(static_cast<uint32_t>(i), masks.whitespace, masks.punctuation, (1u << ascii_bytes) - 1);
+                i += static_cast<int32_t>(ascii_bytes);
+                if (ascii_bytes == chunk_size) continue;
+            }
+#endif
+            const auto start = static_cast<uint32_t>(i);
+            UChar32 c;
+            U8_NEXT(data, i, n, c);
+
+            // Ill-formed bytes are kept as part of the surrounding word.
+            const CharClass char_class = c < 0 ? CharClass::Word : classify(static_cast<char32_t>(c));
+            switch (char_class) {
+                case CharClass::Word: writer.word(start); break;
+                case CharClass::Whitespace: writer.close(start); break;
+                case CharClass::Punctuation: writer.punctuation(start, static_cast<uint32_t>(i)); break;
+            }
+        }
+        writer.close(static_cast<uint32_t>(n));
+    }
+
+    CharClass PreTokenizer::classify(const char32_t code_point) {
+        if (code_point < 128) return ascii_table[code_point];
+        if (code_point > max_code_point) return CharClass::Word;
+        return code_point_table().lookup(code_point);
+    }
+
+} // namespace sentencpp::tokenizer
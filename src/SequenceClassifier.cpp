@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+#include <sentenCPP/inference/SequenceClassifier.h>
+#include <sentenCPP/embedding_utils/VectorMaths.h>
+#include "BatchEncoding.h"
+
+using json = nlohmann::json;
+
+namespace sentencpp::inference {
+
+    SequenceClassifier::SequenceClassifier(
+        const tokenizer::WordPiece& tokenizer,
+        OnnxEngine& engine,
+        const SequenceClassifierConfig& config
+    ) :
+        tokenizer_(tokenizer),
+        engine_(engine),
+        config_(config)
+    {
+        if (!config_.model_config_path.empty()) load_model_config(config_.model_config_path);
+    }
+
+
+    // PUBLIC METHODS --------------------------------------------------------------------------------------------------
+
+    std::vector<std::vector<LabelScore>> SequenceClassifier::classify(const std::vector<std::string>& texts) {
+        if (texts.empty()) return {};
+
+        const std::size_t batch_size = texts.size();
+        const BatchInputs inputs = detail::encode_batch(batch_size, tokenizer_.get_config().max_length, input_ids_,
+            attention_mask_, segment_ids_, [&](const std::size_t row, const tokenizer::EncodingBuffers& out) {
+                return tokenizer_.tokenize(texts[row], scratch_, out);
+            });
+        TensorOutput logits = engine_.run(inputs);
+
+        if (logits.shape.size() != 2 || logits.shape[0] != static_cast<int64_t>(batch_size) || logits.shape[1] <= 0) {
+            throw std::runtime_error("Sequence classification output must have shape [batch_size, num_labels].");
+        }
+        const auto num_labels = static_cast<std::size_t>(logits.shape[1]);
+
+        // Activations run over the whole [batch_size, num_labels] matrix at once.
+        ClassifierActivation activation = config_.activation;
+        if (activation == ClassifierActivation::Auto) {
+            activation = multi_label_ || num_labels == 1 ? ClassifierActivation::Sigmoid : ClassifierActivation::Softmax;
+        }
+        if (activation == ClassifierActivation::Softmax) {
+            embedding_utils::VectorMaths::softmax_rows(logits.data, num_labels);
+        } else if (activation == ClassifierActivation::Sigmoid) {
+            embedding_utils::VectorMaths::sigmoid_inplace(logits.data);
+        }
+
+        const std::size_t k = std::min(config_.top_k, num_labels);
+        order_.resize(num_labels);
+        std::vector<std::vector<LabelScore>> results(batch_size);
+
+        for (std::size_t row = 0; row < batch_size; ++row) {
+            const float* scores = logits.data.data() + row * num_labels;
+            std::iota(order_.begin(), order_.end(), 0);
+            std::partial_sort(order_.begin(), order_.begin() + static_cast<std::ptrdiff_t>(k), order_.end(),
+                [scores](const uint32_t a, const uint32_t b) { return scores[a] > scores[b] || (scores[a] == scores[b] && a < b); });
+
+            results[row].reserve(k);
+            for (std::size_t i = 0; i < k; ++i) {
+                const uint32_t id = order_[i];
+                const std::string_view label = id < labels_.size() ? std::string_view(labels_[id]) : std::string_view();
+                results[row].push_back(LabelScore{id, label, scores[id]});
+            }
+        }
+        return results;
+    }
+
+    std::vector<LabelScore> SequenceClassifier::classify(const std::string_view text) {
+        return std::move(classify(std::vector<std::string>{std::string(text)}).front());
+    }
+
+
+    // PRIVATE METHODS -------------------------------------------------------------------------------------------------
+
+    void SequenceClassifier::load_model_config(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) throw std::runtime_error("Unable to open model config file: " + path);
+
+        try {
+            json model_config;
+            file >> model_config;
+
+            if (model_config.contains("id2label")) {
+                const json& id2label = model_config.at("id2label");
+                // Hugging Face numbers labels 0..n-1, so an id past the size of the map is corrupt rather than sparse.
+                const std::size_t num_labels = id2label.size();
+                for (const auto& [key, name] : id2label.items()) {
+                    std::size_t id = 0;
+                    const auto [end, error] = std::from_chars(key.data(), key.data() + key.size(), id);
+                    if (error != std::errc() || end != key.data() + key.size() || id >= num_labels) {
+                        throw std::runtime_error("Invalid label id '" + key + "' in model config '" + path +
+                                                 "': expected an integer below " + std::to_string(num_labels) + ".");
+                    }
+                    if (id >= labels_.size()) labels_.resize(id + 1);
+                    labels_[id] = name.get<std::string>();
+                }
+            }
+            multi_label_ = model_config.value("problem_type", std::string()) == "multi_label_classification";
+        } catch (const json::exception& e) {
+            throw std::runtime_error("Invalid model config '" + path + "': " + e.what());
+        }
+    }
+
+} // namespace sentencpp::inference
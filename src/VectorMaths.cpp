@@ -1,9 +1,96 @@
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <algorithm>
 #include <sentenCPP/embedding_utils/VectorMaths.h>
 
+#if defined(__AVX2__) && defined(__FMA__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
 namespace sentencpp::embedding_utils {
 
+    namespace {
+
+        // Cephes-style expf: e^x = 2^n * e^r with n = round(x / ln 2) and |r| <= ln(2) / 2, where e^r comes from a
+        // minimax polynomial. ln 2 is split in two so that r is computed without cancellation error.
+        constexpr float exp_max_input = 88.0f;  // Keeps n <= 127, so 2^n is still a normal float.
+        constexpr float exp_min_input = -87.3365447504f;
+        constexpr float log2_e = 1.44269504088896341f;
+        constexpr float ln2_high = 0.693359375f;
+        constexpr float ln2_low = -2.12194440e-4f;
+        constexpr float exp_poly[6] = {
+            1.9875691500e-4f, 1.3981999507e-3f, 8.3334519073e-3f, 4.1665795894e-2f, 1.6666665459e-1f, 5.0000001201e-1f
+        };
+
+        float approximate_exp(float x) {
+            x = std::clamp(x, exp_min_input, exp_max_input);
+            const float n = std::nearbyint(x * log2_e);
+            x = x - n * ln2_high - n * ln2_low;
+
+            float y = exp_poly[0];
+            for (int i = 1; i < 6; ++i) y = y * x + exp_poly[i];
+            y = y * x * x + x + 1.0f;
+
+            const auto bits = static_cast<uint32_t>(static_cast<int32_t>(n) + 127) << 23;
+            float scale;
+            std::memcpy(&scale, &bits, sizeof(scale));
+            return y * scale;
+        }
+
+    } // namespace
+
+    float VectorMaths::dot_product(
+        const std::span<const float> vec_a,
+        const std::span<const float> vec_b
+    ) {
+        const size_t n = std::min(vec_a.size(), vec_b.size());
+        const float* a = vec_a.data();
+        const float* b = vec_b.data();
+        size_t i = 0;
+        float sum = 0.0f;
+
+        // Two independent accumulators hide the latency of the multiply-add chain.
+#if defined(__AVX2__) && defined(__FMA__)
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+        for (; i + 16 <= n; i += 16) {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        }
+        const __m256 acc = _mm256_add_ps(acc0, acc1);
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        sum = _mm_cvtss_f32(half);
+#elif defined(__SSE2__) || defined(_M_X64)
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+        for (; i + 8 <= n; i += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        __m128 acc = _mm_add_ps(acc0, acc1);
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+        sum = _mm_cvtss_f32(acc);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+        for (; i + 8 <= n; i += 8) {
+            acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+            acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+        sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+
+        for (; i < n; ++i) sum += a[i] * b[i];
+        return sum;
+    }
+
     std::vector<float> VectorMaths::mean_pooling(
         const std::vector<std::vector<float>>& token_embeddings,
         const std::vector<tokenizer::Token>& original_tokens
@@ -30,7 +117,28 @@ namespace sentencpp::embedding_utils {
         return sentence_embedding;
     }
 
-    static std::vector<float> min_pooling(
+    void VectorMaths::mean_pooling(
+        const std::span<const float> token_embeddings,
+        const std::span<const int64_t> attention_mask,
+        const std::span<float> sentence_embedding
+    ) {
+        const size_t hidden_size = sentence_embedding.size();
+        std::ranges::fill(sentence_embedding, 0.0f);
+        int valid_token_count = 0;
+
+        for (size_t i = 0; i < attention_mask.size() && (i + 1) * hidden_size <= token_embeddings.size(); ++i) {
+            if (attention_mask[i] != 1) continue;
+            valid_token_count++;
+            const float* token = token_embeddings.data() + i * hidden_size;
+            for (size_t d = 0; d < hidden_size; ++d) sentence_embedding[d] += token[d];
+        }
+
+        if (valid_token_count > 0) {
+            for (float& val : sentence_embedding) val /= static_cast<float>(valid_token_count);
+        }
+    }
+
+    std::vector<float> VectorMaths::min_pooling(
         const std::vector<std::vector<float>>& token_embeddings,
         const std::vector<tokenizer::Token>& original_tokens
     ) {
@@ -51,7 +159,7 @@ namespace sentencpp::embedding_utils {
         return has_valid_token ? sentence_embedding : std::vector<float>(hidden_size, 0.0f);
     }
 
-    static std::vector<float> max_pooling(
+    std::vector<float> VectorMaths::max_pooling(
         const std::vector<std::vector<float>>& token_embeddings,
         const std::vector<tokenizer::Token>& original_tokens
     ) {
@@ -72,9 +180,16 @@ namespace sentencpp::embedding_utils {
         return has_valid_token ? sentence_embedding : std::vector<float>(hidden_size, 0.0f);
     }
 
-    static float euclidean_distance(
+    float VectorMaths::euclidean_distance(
         const std::vector<float>& vec_a,
         const std::vector<float>& vec_b
+    ) {
+        return euclidean_distance(std::span<const float>(vec_a), std::span<const float>(vec_b));
+    }
+
+    float VectorMaths::euclidean_distance(
+        const std::span<const float> vec_a,
+        const std::span<const float> vec_b
     ) {
         if (vec_a.size() != vec_b.size()) return -1.0f;
 
@@ -89,6 +204,13 @@ namespace sentencpp::embedding_utils {
     float VectorMaths::cosine_similarity(
         const std::vector<float>& vec_a,
         const std::vector<float>& vec_b
+    ) {
+        return cosine_similarity(std::span<const float>(vec_a), std::span<const float>(vec_b));
+    }
+
+    float VectorMaths::cosine_similarity(
+        const std::span<const float> vec_a,
+        const std::span<const float> vec_b
     ) {
         if (vec_a.size() != vec_b.size()) return 0.0f;
 
@@ -101,22 +223,121 @@ namespace sentencpp::embedding_utils {
         return (norm_a == 0 || norm_b == 0) ? 0.0f : dot / (std::sqrt(norm_a) * std::sqrt(norm_b));
     }
 
+    std::vector<std::pair<std::size_t, float>> VectorMaths::top_k_cosine(
+        const MatrixView& matrix,
+        const std::span<const float> query,
+        const std::size_t k
+    ) {
+        std::vector<std::pair<std::size_t, float>> scores;
+        if (matrix.cols != query.size()) return scores;
+
+        scores.reserve(matrix.rows);
+        for (size_t i = 0; i < matrix.rows; ++i) scores.emplace_back(i, cosine_similarity(matrix.row(i), query));
+
+        const size_t n = std::min(k, scores.size());
+        std::partial_sort(scores.begin(), scores.begin() + n, scores.end(), [](const auto& a, const auto& b) {
+            return a.second > b.second;
+        });
+        scores.resize(n);
+        return scores;
+    }
+
     std::vector<float> VectorMaths::calculate_softmax(
         const std::vector<float>& logits
     ) {
-        std::vector<float> probabilities(logits.size());
+        std::vector<float> probabilities(logits);
+        softmax_rows(probabilities, probabilities.size());
+        return probabilities;
+    }
 
-        // Find max element.
-        float max_logit = *std::max_element(logits.begin(), logits.end());
+    void VectorMaths::exp_inplace(const std::span<float> values) {
+        float* v = values.data();
+        const size_t n = values.size();
+        size_t i = 0;
 
-        float sum = 0.0f;
-        for (size_t i = 0; i < logits.size(); ++i) {
-            probabilities[i] = std::exp(logits[i] - max_logit);
-            sum += probabilities[i];
+#if defined(__AVX2__) && defined(__FMA__)
+        for (; i + 8 <= n; i += 8) {
+            __m256 x = _mm256_loadu_ps(v + i);
+            x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(exp_min_input)), _mm256_set1_ps(exp_max_input));
+            const __m256 fx = _mm256_round_ps(
+                _mm256_mul_ps(x, _mm256_set1_ps(log2_e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC
+            );
+            x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(ln2_high), x);
+            x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(ln2_low), x);
+
+            __m256 y = _mm256_set1_ps(exp_poly[0]);
+            for (int k = 1; k < 6; ++k) y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(exp_poly[k]));
+            y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+            const __m256i exponent = _mm256_slli_epi32(
+                _mm256_add_epi32(_mm256_cvtps_epi32(fx), _mm256_set1_epi32(127)), 23
+            );
+            _mm256_storeu_ps(v + i, _mm256_mul_ps(y, _mm256_castsi256_ps(exponent)));
         }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (; i + 4 <= n; i += 4) {
+            __m128 x = _mm_loadu_ps(v + i);
+            x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(exp_min_input)), _mm_set1_ps(exp_max_input));
+            // Converting with the default rounding mode rounds to nearest, like std::nearbyint.
+            const __m128i n_int = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(log2_e)));
+            const __m128 fx = _mm_cvtepi32_ps(n_int);
+            x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(ln2_high)));
+            x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(ln2_low)));
 
-        for (float& p : probabilities) p /= sum;
-        return probabilities;
+            __m128 y = _mm_set1_ps(exp_poly[0]);
+            for (int k = 1; k < 6; ++k) y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(exp_poly[k]));
+            y = _mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(x, x)), _mm_add_ps(x, _mm_set1_ps(1.0f)));
+
+            const __m128i exponent = _mm_slli_epi32(_mm_add_epi32(n_int, _mm_set1_epi32(127)), 23);
+            _mm_storeu_ps(v + i, _mm_mul_ps(y, _mm_castsi128_ps(exponent)));
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        for (; i + 4 <= n; i += 4) {
+            float32x4_t x = vld1q_f32(v + i);
+            x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(exp_min_input)), vdupq_n_f32(exp_max_input));
+            const int32x4_t n_int = vcvtnq_s32_f32(vmulq_n_f32(x, log2_e));
+            const float32x4_t fx = vcvtq_f32_s32(n_int);
+            x = vfmsq_f32(x, fx, vdupq_n_f32(ln2_high));
+            x = vfmsq_f32(x, fx, vdupq_n_f32(ln2_low));
+
+            float32x4_t y = vdupq_n_f32(exp_poly[0]);
+            for (int k = 1; k < 6; ++k) y = vfmaq_f32(vdupq_n_f32(exp_poly[k]), y, x);
+            y = vfmaq_f32(vaddq_f32(x, vdupq_n_f32(1.0f)), y, vmulq_f32(x, x));
+
+            const int32x4_t exponent = vshlq_n_s32(vaddq_s32(n_int, vdupq_n_s32(127)), 23);
+            vst1q_f32(v + i, vmulq_f32(y, vreinterpretq_f32_s32(exponent)));
+        }
+#endif
+
+        for (; i < n; ++i) v[i] = approximate_exp(v[i]);
+    }
+
+    void VectorMaths::softmax_rows(const std::span<float> matrix, const std::size_t cols) {
+        if (cols == 0 || matrix.empty()) return;
+        const size_t rows = matrix.size() / cols;
+
+        // Shift each row by its maximum, exponentiate the whole matrix in one pass, then normalise each row.
+        for (size_t r = 0; r < rows; ++r) {
+            const auto row = matrix.subspan(r * cols, cols);
+            const float max_logit = *std::ranges::max_element(row);
+            for (float& val : row) val -= max_logit;
+        }
+
+        exp_inplace(matrix.first(rows * cols));
+
+        for (size_t r = 0; r < rows; ++r) {
+            const auto row = matrix.subspan(r * cols, cols);
+            float sum = 0.0f;
+            for (const float val : row) sum += val;
+            const float inverse_sum = 1.0f / sum;
+            for (float& val : row) val *= inverse_sum;
+        }
+    }
+
+    void VectorMaths::sigmoid_inplace(const std::span<float> values) {
+        for (float& val : values) val = -val;
+        exp_inplace(values);
+        for (float& val : values) val = 1.0f / (1.0f + val);
     }
 
 } // namespace sentencpp::embedding_utils
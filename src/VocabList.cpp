@@ -1,22 +1,32 @@
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <functional>
 #include <sentenCPP/tokenizer/VocabList.h>
 
 namespace sentencpp::tokenizer {
 
-    bool VocabList::set_token(const std::string& token_str, const int64_t token_id) {
+    static uint32_t hash_token(const std::string_view token_str) {
+        return static_cast<uint32_t>(std::hash<std::string_view>{}(token_str));
+    }
+
+    bool VocabList::set_token(const std::string_view token_str, const int64_t token_id) {
         // Check the token and id.
-        if (token_str.empty() || string_to_id_map_.contains(token_str)) return false;
+        if (token_str.empty() || token_id < 0 || token_id >= empty_slot) return false;
+        const uint32_t hash = hash_token(token_str);
+        if (find_slot(token_str, hash) != nullptr) return false;
+        const auto index = static_cast<std::size_t>(token_id);
 
         // Check that we don't overwrite data.
-        if (token_id < id_to_string_map_.size() && !id_to_string_map_[token_id].empty()) return false;
+        if (index < id_to_ref_.size() && id_to_ref_[index].length != 0) return false;
 
         // Ensure vector is large enough.
-        if (token_id >= id_to_string_map_.size()) id_to_string_map_.resize(token_id + 1);
+        if (index >= id_to_ref_.size()) id_to_ref_.resize(index + 1, TokenRef{0, 0});
 
         // Set the mappings.
-        string_to_id_map_[token_str] = token_id;
-        id_to_string_map_[token_id] = token_str;
+        id_to_ref_[index] = TokenRef{static_cast<uint32_t>(pool_.size()), static_cast<uint32_t>(token_str.size())};
+        pool_.append(token_str);
+        insert_slot(hash, static_cast<uint32_t>(token_id));
         return true;
     }
 
@@ -26,26 +36,87 @@ namespace sentencpp::tokenizer {
         return true;
     }
 
-    std::optional<int64_t> VocabList::token_to_id(const std::string& token_str) const {
-        const auto got = string_to_id_map_.find(token_str);
-        if (got == string_to_id_map_.end()) return std::nullopt;
-        return got->second;
+    std::unordered_map<std::string, int64_t> VocabList::get_string_to_id_map() const {
+        std::unordered_map<std::string, int64_t> string_to_id_map;
+        string_to_id_map.reserve(token_count_);
+        for (size_t id = 0; id < id_to_ref_.size(); ++id) {
+            if (id_to_ref_[id].length != 0) string_to_id_map.emplace(ref_to_view(id_to_ref_[id]), static_cast<int64_t>(id));
+        }
+        return string_to_id_map;
+    }
+
+    std::vector<std::string> VocabList::get_id_to_string_map() const {
+        std::vector<std::string> id_to_string_map;
+        id_to_string_map.reserve(id_to_ref_.size());
+        for (const TokenRef ref : id_to_ref_) id_to_string_map.emplace_back(ref_to_view(ref));
+        return id_to_string_map;
+    }
+
+    std::optional<int64_t> VocabList::token_to_id(const std::string_view token_str) const {
+        const Slot* slot = find_slot(token_str, hash_token(token_str));
+        if (slot == nullptr) return std::nullopt;
+        return slot->id;
     }
 
     std::optional<std::string> VocabList::id_to_token(const int64_t token_id) const {
-        if (token_id >= id_to_string_map_.size()) return std::nullopt;
-        const std::string& token_str = id_to_string_map_[token_id];
-        if (token_str.empty()) return std::nullopt;
-        return token_str;
+        const auto token_str = id_to_token_view(token_id);
+        if (!token_str.has_value()) return std::nullopt;
+        return std::string(token_str.value());
+    }
+
+    std::optional<std::string_view> VocabList::id_to_token_view(const int64_t token_id) const {
+        if (token_id < 0 || static_cast<std::size_t>(token_id) >= id_to_ref_.size()) return std::nullopt;
+        const TokenRef ref = id_to_ref_[static_cast<std::size_t>(token_id)];
+        if (ref.length == 0) return std::nullopt;
+        return ref_to_view(ref);
     }
 
     std::ostream& operator<<(std::ostream& os, const VocabList& instance) {
         os << std::left << std::setw(20) << "Token" << " | " << "ID" << "\n";
         os << std::string(30, '-') << "\n";
-        for (const auto& [token, id] : instance.string_to_id_map_) {
-            os << std::left << std::setw(20) << token << " | " << id << "\n";
+        for (size_t id = 0; id < instance.id_to_ref_.size(); ++id) {
+            if (instance.id_to_ref_[id].length == 0) continue;
+            os << std::left << std::setw(20) << instance.ref_to_view(instance.id_to_ref_[id]) << " | " << id << "\n";
         }
         return os;
     }
 
+
+    // PRIVATE METHODS -------------------------------------------------------------------------------------------------
+
+    const VocabList::Slot* VocabList::find_slot(const std::string_view token_str, const uint32_t hash) const {
+        if (slots_.empty()) return nullptr;
+
+        const size_t mask = slots_.size() - 1;
+        for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+            const Slot& slot = slots_[i];
+            if (slot.id == empty_slot) return nullptr;
+            if (slot.hash == hash && ref_to_view(id_to_ref_[slot.id]) == token_str) return &slot;
+        }
+    }
+
+    void VocabList::insert_slot(const uint32_t hash, const uint32_t id) {
+        if ((token_count_ + 1) * 2 > slots_.size()) grow_slots();
+
+        const size_t mask = slots_.size() - 1;
+        size_t i = hash & mask;
+        while (slots_[i].id != empty_slot) i = (i + 1) & mask;
+
+        slots_[i] = Slot{hash, id};
+        token_count_++;
+    }
+
+    void VocabList::grow_slots() {
+        std::vector<Slot> old_slots(std::max<size_t>(16, slots_.size() * 2), Slot{0, empty_slot});
+        old_slots.swap(slots_);
+
+        const size_t mask = slots_.size() - 1;
+        for (const Slot& slot : old_slots) {
+            if (slot.id == empty_slot) continue;
+            size_t i = slot.hash & mask;
+            while (slots_[i].id != empty_slot) i = (i + 1) & mask;
+            slots_[i] = slot;
+        }
+    }
+
 } // namespace sentencpp::tokenizer
@@ -2,13 +2,16 @@
 #include <fstream>
 #include <string>
 #include <algorithm>
-#include <cctype>
 #include <vector>
+#include <stdexcept>
 #include <unicode/utypes.h>
+#include <unicode/uchar.h>
+#include <unicode/utf8.h>
 #include <unicode/unistr.h>
-#include <unicode/translit.h>
+#include <unicode/normalizer2.h>
 #include <nlohmann/json.hpp>
 #include <sentenCPP/tokenizer/VocabList.h>
+#include <sentenCPP/tokenizer/PreTokenizer.h>
 #include <sentenCPP/tokenizer/WordPiece.h>
 
 using json = nlohmann::json;
@@ -19,6 +22,9 @@ namespace sentencpp::tokenizer {
         config_(config),
         vocab_list_(std::make_unique<VocabList>())
     {
+        // Every encoding holds at least [CLS] and [SEP].
+        if (config_.max_length < 2) throw std::invalid_argument("max_length must be at least 2.");
+
         vocab_list_->set_special_token(config_.padding_token, TokenRole::Padding);
         vocab_list_->set_special_token(config_.unknown_token, TokenRole::Unknown);
         vocab_list_->set_special_token(config_.classification_token, TokenRole::Classification);
@@ -26,10 +32,7 @@ namespace sentencpp::tokenizer {
         vocab_list_->set_special_token(config_.mask_token, TokenRole::Mask);
 
         std::ifstream file(config_.config_path);
-        if (!file.is_open()) {
-            std::cerr << "Unable to open config file: " << config_.config_path << std::endl;
-            exit(-1);
-        }
+        if (!file.is_open()) throw std::runtime_error("Unable to open config file: " + config_.config_path);
 
         try {
             json tokenizer_config;
@@ -58,9 +61,45 @@ namespace sentencpp::tokenizer {
                     );
                 }
             }
-        } catch (const json::parse_error& e) {
-            std::cerr << "JSON parse error: " << e.what() << std::endl;
-            exit(-1);
+
+            padding_id_ = vocab_list_->token_to_id(config_.padding_token).value();
+            unknown_id_ = vocab_list_->token_to_id(config_.unknown_token).value();
+            classification_id_ = vocab_list_->token_to_id(config_.classification_token).value();
+            separator_id_ = vocab_list_->token_to_id(config_.separator_token).value();
+
+            const json::json_pointer added_tokens_pointer(config_.added_tokens_key);
+            if (tokenizer_config.contains(added_tokens_pointer)) {
+                std::vector<AddedToken> added_tokens;
+                TokenizerScratch scratch;
+
+                for (const auto& entry : tokenizer_config.at(added_tokens_pointer)) {
+                    AddedToken token{
+                        entry.at("content").get<std::string>(),
+                        entry.at("id").get<int64_t>(),
+                        entry.value("single_word", false),
+                        entry.value("lstrip", false),
+                        entry.value("rstrip", false),
+                        entry.value("normalized", true),
+                        entry.value("special", false)
+                    };
+
+                    // Added tokens do not have to appear in the model vocabulary.
+                    if (vocab_list_->token_to_id(token.content) != token.id && !vocab_list_->set_token(token.content, token.id)) {
+                        std::cerr << "Warning: Could not set added token '" << token.content << "' with ID " << token.id << std::endl;
+                    }
+
+                    // Normalised tokens are matched against normalised text, so their content goes through the same
+                    // steps, Chinese character padding included, as in the HuggingFace added vocabulary.
+                    if (token.normalized) {
+                        normalise(token.content, scratch);
+                        token.content = scratch.normalised_text;
+                    }
+                    added_tokens.push_back(std::move(token));
+                }
+                added_vocabulary_ = AddedVocabulary(added_tokens);
+            }
+        } catch (const json::exception& e) {
+            throw std::runtime_error("Invalid tokenizer config '" + config_.config_path + "': " + e.what());
         }
     }
 
@@ -68,182 +107,413 @@ namespace sentencpp::tokenizer {
     // PUBLIC METHODS --------------------------------------------------------------------------------------------------
 
     std::vector<Token> WordPiece::tokenize(std::string_view text) const {
-        std::string normalised_text(text);  // Local copy to work with.
-        if (config_.clean_text) clean_text_inplace(normalised_text);
-        if (config_.to_lowercase) to_lowercase_inplace(normalised_text);
-        if (config_.strip_accents) strip_accents_inplace(normalised_text);
-        if (config_.handle_chinese_chars) handle_chinese_chars_inplace(normalised_text);
-
-        // std::cout << "Normalised text: " << normalised_text << std::endl;
-
-        std::vector<std::string_view> words = split_text(normalised_text);
+        TokenizerScratch scratch;
         std::vector<Token> all_tokens;
+        all_tokens.reserve(config_.max_length);
+        all_tokens.push_back(Token{classification_id_, "", 1, 0});
 
-        for (const auto& word : words) {
-            std::vector<Token> word_tokens = encode_word(word);
-            all_tokens.insert(all_tokens.end(), word_tokens.begin(), word_tokens.end());
-        }
+        encode_text(text, scratch, [&](const std::string_view word, const std::span<const int64_t> ids) {
+            for (const int64_t id : ids) all_tokens.push_back(Token{id, std::string(token_text(id, word)), 1, 0});
+            return true;
+        });
 
         post_processing(all_tokens);
         return all_tokens;
     }
 
+    std::size_t WordPiece::tokenize(std::string_view text, TokenizerScratch& scratch, const EncodingBuffers& out) const {
+        const std::size_t max_length = config_.max_length;
+        check_buffers(out);
+
+        // Reserve index 0 for [CLS] and the last real slot for [SEP].
+        const std::size_t limit = max_length - 1;
+        std::size_t n = 0;
+        bool truncated = false;
+        out.input_ids[n++] = classification_id_;
+
+        encode_text(text, scratch, [&](std::string_view, const std::span<const int64_t> ids) {
+            for (const int64_t id : ids) {
+                if (n == limit) {
+                    truncated = true;
+                    return false;
+                }
+                out.input_ids[n++] = id;
+            }
+            return true;
+        });
 
-    // PRIVATE METHODS -------------------------------------------------------------------------------------------------
+        if (truncated && config_.warn_on_truncation) std::cerr << "Warning: Tokens truncated. max_length = " << max_length << std::endl;
+        out.input_ids[n++] = separator_id_;
 
-    std::vector<std::string_view> WordPiece::split_text(const std::string_view text) {
-        std::vector<std::string_view> words;
-        size_t i = 0;
-        const size_t n = text.length();
+        std::fill(out.input_ids.begin() + n, out.input_ids.begin() + max_length, padding_id_);
+        std::fill(out.attention_mask.begin(), out.attention_mask.begin() + n, 1);
+        std::fill(out.attention_mask.begin() + n, out.attention_mask.begin() + max_length, 0);
+        std::fill(out.segment_ids.begin(), out.segment_ids.begin() + max_length, 0);
+        return n;
+    }
 
-        while (i < n) {
-            // Skip Whitespace.
-            if (std::isspace(static_cast<unsigned char>(text[i]))) {
-                i++;
-                continue;
-            }
+    std::vector<Token> WordPiece::tokenize_pair(std::string_view first, std::string_view second) const {
+        const std::size_t max_length = config_.max_length;
+        std::vector<int64_t> input_ids(max_length), attention_mask(max_length), segment_ids(max_length);
+        TokenizerScratch scratch;
+
+        // Token text comes from the source words, as in tokenize, so it is collected while the ids are encoded.
+        std::vector<std::string> first_text, second_text;
+        const auto encode = [&](const std::string_view text, std::vector<int64_t>& ids, std::vector<std::string>& texts) {
+            ids.clear();
+            encode_text(text, scratch, [&](const std::string_view word, const std::span<const int64_t> word_ids) {
+                for (const int64_t id : word_ids) {
+                    ids.push_back(id);
+                    texts.emplace_back(token_text(id, word));
+                }
+                return true;
+            });
+        };
+        encode(first, scratch.first_ids, first_text);
+        encode(second, scratch.second_ids, second_text);
+        const std::size_t n = assemble_pair(scratch.first_ids, scratch.second_ids, EncodingBuffers{input_ids, attention_mask, segment_ids});
 
-            // Separate punctuation.
-            if (std::ispunct(static_cast<unsigned char>(text[i]))) {
-                size_t start = i;
-                char punct_char = text[i];
+        // Layout: [CLS] first [SEP] second [SEP] padding. Truncation only drops the tail of each text.
+        const auto n_second = static_cast<std::size_t>(std::count(segment_ids.begin(), segment_ids.begin() + n, 1)) - 1;
+        const std::size_t n_first = n - n_second - 3;
 
-                // Peek ahead to group identical punctuation.
-                while (i < n && text[i] == punct_char && std::ispunct(static_cast<unsigned char>(text[i]))) i++;
+        std::vector<Token> tokens;
+        tokens.reserve(max_length);
+        for (std::size_t i = 0; i < max_length; ++i) {
+            std::string text;
+            if (i >= 1 && i <= n_first) text = std::move(first_text[i - 1]);
+            else if (i >= n_first + 2 && i < n_first + 2 + n_second) text = std::move(second_text[i - n_first - 2]);
+            tokens.push_back(Token{input_ids[i], std::move(text), attention_mask[i], segment_ids[i]});
+        }
+        return tokens;
+    }
 
-                words.push_back(text.substr(start, i - start));
-                continue;
+    std::size_t WordPiece::tokenize_pair(
+        std::string_view first,
+        std::string_view second,
+        TokenizerScratch& scratch,
+        const EncodingBuffers& out
+    ) const {
+        encode_ids(first, scratch, scratch.first_ids);
+        encode_ids(second, scratch, scratch.second_ids);
+        return assemble_pair(scratch.first_ids, scratch.second_ids, out);
+    }
+
+    void WordPiece::encode_ids(std::string_view text, TokenizerScratch& scratch, std::vector<int64_t>& ids) const {
+        ids.clear();
+        encode_text(text, scratch, [&](std::string_view, const std::span<const int64_t> word_ids) {
+            ids.insert(ids.end(), word_ids.begin(), word_ids.end());
+            return true;
+        });
+    }
+
+    std::size_t WordPiece::assemble_pair(
+        std::span<const int64_t> first,
+        std::span<const int64_t> second,
+        const EncodingBuffers& out
+    ) const {
+        const std::size_t max_length = config_.max_length;
+        if (max_length < 3) throw std::invalid_argument("Pair encoding needs a max_length of at least 3.");
+        check_buffers(out);
+
+        // Reserve room for [CLS] and two [SEP] tokens.
+        const std::size_t budget = max_length - 3;
+        std::size_t n_first = first.size();
+        std::size_t n_second = second.size();
+
+        if (n_first + n_second > budget) {
+            switch (config_.truncation_strategy) {
+                case TruncationStrategy::LongestFirst: {
+                    // Closed form of repeatedly trimming the longer text (the second on ties).
+                    if (std::min(n_first, n_second) * 2 <= budget) {
+                        if (n_first > n_second) n_first = budget - n_second;
+                        else n_second = budget - n_first;
+                    } else {
+                        n_first = (budget + 1) / 2;
+                        n_second = budget / 2;
+                    }
+                    break;
+                }
+                case TruncationStrategy::OnlySecond: {
+                    // If the first text alone is too long it is cut as well, leaving the second empty.
+                    n_first = std::min(n_first, budget);
+                    n_second = budget - n_first;
+                    break;
+                }
             }
+            if (config_.warn_on_truncation) std::cerr << "Warning: Tokens truncated. max_length = " << max_length << std::endl;
+        }
 
-            if (std::ispunct(static_cast<unsigned char>(text[i]))) {
-                words.push_back(text.substr(i, 1));
-                i++;
-                continue;
+        std::size_t n = 0;
+        const auto write = [&](const int64_t id, const int64_t segment) {
+            out.input_ids[n] = id;
+            out.segment_ids[n] = segment;
+            n++;
+        };
+
+        write(classification_id_, 0);
+        for (std::size_t i = 0; i < n_first; ++i) write(first[i], 0);
+        write(separator_id_, 0);
+        for (std::size_t i = 0; i < n_second; ++i) write(second[i], 1);
+        write(separator_id_, 1);
+
+        std::fill(out.input_ids.begin() + n, out.input_ids.begin() + max_length, padding_id_);
+        std::fill(out.segment_ids.begin() + n, out.segment_ids.begin() + max_length, 0);
+        std::fill(out.attention_mask.begin(), out.attention_mask.begin() + n, 1);
+        std::fill(out.attention_mask.begin() + n, out.attention_mask.begin() + max_length, 0);
+        return n;
+    }
+
+
+    // PRIVATE METHODS -------------------------------------------------------------------------------------------------
+
+    void WordPiece::check_buffers(const EncodingBuffers& out) const {
+        const std::size_t max_length = config_.max_length;
+        if (out.input_ids.size() < max_length || out.attention_mask.size() < max_length || out.segment_ids.size() < max_length) {
+            throw std::invalid_argument("Encoding buffers must hold at least max_length elements.");
+        }
+    }
+
+    std::string_view WordPiece::token_text(const int64_t id, const std::string_view word) const {
+        return id == unknown_id_ ? word : vocab_list_->id_to_token_view(id).value_or(word);
+    }
+
+    template <typename Visitor>
+    void WordPiece::encode_text(const std::string_view text, TokenizerScratch& scratch, Visitor&& visit) const {
+        // Added tokens matched on the raw input split it into protected and normal segments.
+        added_vocabulary_.find(text, false, scratch.raw_matches);
+
+        std::size_t segment_begin = 0;
+        for (const auto& [begin, end, id] : scratch.raw_matches) {
+            if (!encode_segment(text.substr(segment_begin, begin - segment_begin), scratch, visit)) return;
+            if (!visit(text.substr(begin, end - begin), std::span<const int64_t>(&id, 1))) return;
+            segment_begin = end;
+        }
+        encode_segment(text.substr(segment_begin), scratch, visit);
+    }
+
+    template <typename Visitor>
+    bool WordPiece::encode_segment(const std::string_view segment, TokenizerScratch& scratch, Visitor& visit) const {
+        if (segment.empty()) return true;
+        normalise(segment, scratch);
+        const std::string_view normalised_text = scratch.normalised_text;
+
+        // Normalised added tokens split the segment again; the pieces in between go through WordPiece.
+        if (added_vocabulary_.has_normalised_tokens()) added_vocabulary_.find(normalised_text, true, scratch.normalised_matches);
+        else scratch.normalised_matches.clear();
+
+        const auto encode_piece = [&](const std::size_t piece_begin, const std::size_t piece_end) {
+            PreTokenizer::split(normalised_text.substr(piece_begin, piece_end - piece_begin), scratch.words);
+            for (const auto& [begin, end] : scratch.words) {
+                const std::string_view word = normalised_text.substr(piece_begin + begin, end - begin);
+                const bool known = encode_word(word, scratch);
+                const std::span<const int64_t> ids = known ? std::span<const int64_t>(scratch.word_ids) : std::span<const int64_t>(&unknown_id_, 1);
+                if (!visit(word, ids)) return false;
             }
+            return true;
+        };
+
+        std::size_t piece_begin = 0;
+        for (const auto& [begin, end, id] : scratch.normalised_matches) {
+            if (!encode_piece(piece_begin, begin)) return false;
+            if (!visit(normalised_text.substr(begin, end - begin), std::span<const int64_t>(&id, 1))) return false;
+            piece_begin = end;
+        }
+        return encode_piece(piece_begin, normalised_text.size());
+    }
 
-            const size_t start = i;
-            while (
-                i < n &&
-                !std::isspace(static_cast<unsigned char>(text[i])) &&
-                !std::ispunct(static_cast<unsigned char>(text[i]))
-            ) i++;
+    void WordPiece::normalise(const std::string_view text, TokenizerScratch& scratch) const {
+        std::string& normalised_text = scratch.normalised_text;
+        normalised_text.assign(text);
 
-            words.push_back(text.substr(start, i - start));
+        // Steps that cannot work in place write into swap_text; swapping keeps both buffers' capacity.
+        if (config_.clean_text) {
+            clean_text(normalised_text, scratch.swap_text);
+            normalised_text.swap(scratch.swap_text);
+        }
+        if (config_.handle_chinese_chars) {
+            pad_chinese_chars(normalised_text, scratch.swap_text);
+            normalised_text.swap(scratch.swap_text);
+        }
+        if (config_.to_lowercase) to_lowercase_inplace(normalised_text);
+        if (config_.strip_accents) {
+            strip_accents(normalised_text, scratch.swap_text);
+            normalised_text.swap(scratch.swap_text);
         }
-        return words;
     }
 
-    std::vector<Token> WordPiece::encode_word(const std::string_view word) const {
-        std::vector<Token> tokens;
+    bool WordPiece::encode_word(const std::string_view word, TokenizerScratch& scratch) const {
+        std::vector<int64_t>& ids = scratch.word_ids;
+        std::string& piece = scratch.piece;
+        ids.clear();
+
         size_t start = 0;
         const size_t n = word.length();
 
-        std::string unknown_token_str = vocab_list_->get_special_token_val(TokenRole::Unknown);
-        int64_t unknown_token_id = vocab_list_->token_to_id(unknown_token_str).value();
-
-        if (n >= config_.max_input_chars_per_word) return {Token{unknown_token_id, std::string(word), 1, 0}};
+        if (n >= config_.max_input_chars_per_word) return false;
 
         while (start < n) {
             size_t end = n;
-            std::optional<uint32_t> best_id = std::nullopt;
-            std::string best_substr;
+            std::optional<int64_t> best_id = std::nullopt;
 
             while (start < end) {
-                std::string substr(word.substr(start, end - start));
-
-                if (start > 0) substr.insert(0, "##");
-
-                if (auto id = vocab_list_->token_to_id(substr)) {
-                    best_id = id;
-                    best_substr = std::move(substr);
-                    break;
+                // Word-initial pieces are looked up in place; continuations need the "##" prefix.
+                if (start == 0) {
+                    best_id = vocab_list_->token_to_id(word.substr(0, end));
+                } else {
+                    piece.assign("##");
+                    piece.append(word.substr(start, end - start));
+                    best_id = vocab_list_->token_to_id(piece);
                 }
+                if (best_id.has_value()) break;
                 end--;
             }
 
             // Entire word is unknown if a match cannot be found.
-            if (!best_id.has_value()) return {Token{unknown_token_id, std::string(word), 1, 0}};
+            if (!best_id.has_value()) return false;
 
-            tokens.push_back(Token{best_id.value(), best_substr, 1, 0});
+            ids.push_back(best_id.value());
             start = end;
         }
-        return tokens;
+        return true;
     }
 
     void WordPiece::post_processing(std::vector<Token>& tokens) const {
-        std::string classification_token_str = vocab_list_->get_special_token_val(TokenRole::Classification);
-        int64_t classification_token_id = vocab_list_->token_to_id(classification_token_str).value();
-        std::string separator_token_str = vocab_list_->get_special_token_val(TokenRole::Separator);
-        int64_t separator_token_id = vocab_list_->token_to_id(separator_token_str).value();
-        std::string padding_token_str = vocab_list_->get_special_token_val(TokenRole::Padding);
-        int64_t padding_token_id = vocab_list_->token_to_id(padding_token_str).value();
-
-        // Reserve index 0 for [CLS] and index 127 for [SEP].
-        if (tokens.size() > (config_.max_length - 2)) {
-            tokens.resize(config_.max_length - 2);
-            std::cerr << "Warning: Tokens truncated. max_length = " << config_.max_length << std::endl;
+        // Index 0 already holds [CLS]. Reserve index max_length - 1 for [SEP].
+        if (tokens.size() > (config_.max_length - 1)) {
+            tokens.resize(config_.max_length - 1);
+            if (config_.warn_on_truncation) std::cerr << "Warning: Tokens truncated. max_length = " << config_.max_length << std::endl;
         }
 
-        tokens.insert(tokens.begin(), Token{classification_token_id, "", 1, 0});
-        tokens.push_back(Token{separator_token_id, "", 1, 0});
+        tokens.push_back(Token{separator_id_, "", 1, 0});
 
         // Add padding if necessary.
-        if (tokens.size() < config_.max_length) {
-            tokens.reserve(config_.max_length);
-            while (tokens.size() < config_.max_length) {
-                tokens.push_back(Token{padding_token_id, "", 0, 0});
-            }
+        while (tokens.size() < config_.max_length) {
+            tokens.push_back(Token{padding_id_, "", 0, 0});
         }
     }
 
-    void WordPiece::clean_text_inplace(std::string& text) {
-        icu::UnicodeString ustr = icu::UnicodeString::fromUTF8(text);
-        icu::UnicodeString cleaned;
+    // Appends a single code point to a UTF-8 string.
+    static void append_utf8(std::string& out, const UChar32 c) {
+        char buf[U8_MAX_LENGTH];
+        int32_t len = 0;
+        U8_APPEND_UNSAFE(buf, len, c);
+        out.append(buf, len);
+    }
+
+    void WordPiece::clean_text(const std::string_view text, std::string& out) {
+        out.clear();
         bool last_was_space = false;
+        const auto* data = reinterpret_cast<const uint8_t*>(text.data());
+        const auto length = static_cast<int32_t>(text.length());
 
-        for (int32_t i = 0; i < ustr.length(); ) {
-            UChar32 c = ustr.char32At(i);
-            int32_t next_i = ustr.moveIndex32(i, 1);
+        for (int32_t i = 0; i < length; ) {
+            const int32_t start = i;
+            UChar32 c;
+            U8_NEXT(data, i, length, c);
             int8_t category = u_charType(c);
 
-            if (c == 0 || c == 0xfffd || category == U_CONTROL_CHAR || category == U_FORMAT_CHAR) {
-                // Skip.
-            } else if (u_isUWhiteSpace(c)) {
+            // Tab, newline and carriage return are whitespace rather than control characters, as in BertNormalizer.
+            const bool is_whitespace = c == '\t' || c == '\n' || c == '\r';
+            const bool is_control = !is_whitespace && (
+                category == U_CONTROL_CHAR || category == U_FORMAT_CHAR ||
+                category == U_PRIVATE_USE_CHAR || category == U_UNASSIGNED
+            );
+
+            if (c <= 0 || c == 0xfffd || is_control) {
+                // Skip. Ill-formed sequences are reported as negative code points.
+            } else if (is_whitespace || u_isUWhiteSpace(c)) {
                 if (!last_was_space) {
-                    cleaned.append((UChar32)' ');
+                    out.push_back(' ');
                     last_was_space = true;
                 }
             } else {
-                cleaned.append(c);
+                out.append(text.substr(start, i - start));
                 last_was_space = false;
             }
-            i = next_i;
         }
-
-        text.clear();
-        cleaned.toUTF8String(text);
     }
 
     void WordPiece::to_lowercase_inplace(std::string& text) {
         std::ranges::transform(text, text.begin(), [](unsigned char c) { return std::tolower(c); });
     }
 
-    void WordPiece::strip_accents_inplace(std::string& text) {
+    void WordPiece::strip_accents(const std::string_view text, std::string& out) {
+        // Equivalent to "NFD; [:M:] Remove; NFC" applied per code point. The normalizers are ICU-owned singletons and
+        // single code point decompositions fit in UnicodeString's inline buffer, so nothing here touches the heap.
         UErrorCode status = U_ZERO_ERROR;
-        icu::UnicodeString ustr = icu::UnicodeString::fromUTF8(text);
+        const icu::Normalizer2* nfd = icu::Normalizer2::getNFDInstance(status);
+        const icu::Normalizer2* nfc = icu::Normalizer2::getNFCInstance(status);
+        if (U_FAILURE(status)) {
+            out.assign(text);
+            return;
+        }
 
-        std::unique_ptr<icu::Transliterator> remover(
-            icu::Transliterator::createInstance("NFD; [:M:] Remove; NFC", UTRANS_FORWARD, status)
-        );
+        out.clear();
+        const auto* data = reinterpret_cast<const uint8_t*>(text.data());
+        const auto length = static_cast<int32_t>(text.length());
 
-        if (U_SUCCESS(status)) remover->transliterate(ustr);
+        for (int32_t i = 0; i < length; ) {
+            const int32_t start = i;
+            UChar32 c;
+            U8_NEXT(data, i, length, c);
 
-        text.clear();
-        ustr.toUTF8String(text);
+            // ASCII and ill-formed bytes pass through untouched.
+            if (c < 0x80) {
+                out.append(text.substr(start, i - start));
+                continue;
+            }
+
+            icu::UnicodeString decomposition;
+            if (!nfd->getDecomposition(c, decomposition)) {
+                if (!(U_GET_GC_MASK(c) & U_GC_M_MASK)) out.append(text.substr(start, i - start));
+                continue;
+            }
+
+            icu::UnicodeString stripped;
+            for (int32_t j = 0; j < decomposition.length(); j = decomposition.moveIndex32(j, 1)) {
+                const UChar32 d = decomposition.char32At(j);
+                if (!(U_GET_GC_MASK(d) & U_GC_M_MASK)) stripped.append(d);
+            }
+
+            icu::UnicodeString composed;
+            nfc->normalize(stripped, composed, status);
+            if (U_FAILURE(status)) {
+                status = U_ZERO_ERROR;
+                composed = stripped;
+            }
+            for (int32_t j = 0; j < composed.length(); j = composed.moveIndex32(j, 1)) {
+                append_utf8(out, composed.char32At(j));
+            }
+        }
     }
 
-    void WordPiece::handle_chinese_chars_inplace(std::string& text) {
-        std::cerr << "Warning: Method handle_chinese_chars_inplace is not implemented" << std::endl;
+    void WordPiece::pad_chinese_chars(const std::string_view text, std::string& out) {
+        // Surrounds every CJK ideograph with spaces so the pre-tokenizer makes each one its own word, as in
+        // BertNormalizer. The ranges are the CJK Unified Ideographs blocks and their extensions A-E, and the two CJK
+        // Compatibility Ideographs blocks. Hiragana, Katakana and Hangul are not included.
+        const auto is_chinese = [](const UChar32 c) {
+            return (c >= 0x4E00 && c <= 0x9FFF) || (c >= 0x3400 && c <= 0x4DBF) || (c >= 0x20000 && c <= 0x2A6DF) ||
+                (c >= 0x2A700 && c <= 0x2CEAF) || (c >= 0xF900 && c <= 0xFAFF) || (c >= 0x2F800 && c <= 0x2FA1F);
+        };
+
+        out.clear();
+        const auto* data = reinterpret_cast<const uint8_t*>(text.data());
+        const auto length = static_cast<int32_t>(text.length());
+
+        for (int32_t i = 0; i < length; ) {
+            const int32_t start = i;
+            UChar32 c;
+            U8_NEXT(data, i, length, c);
+
+            if (is_chinese(c)) {
+                out.push_back(' ');
+                out.append(text.substr(start, i - start));
+                out.push_back(' ');
+            } else {
+                out.append(text.substr(start, i - start));
+            }
+        }
     }
 
 } // namespace sentencpp::tokenizer
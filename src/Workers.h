@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Internal helpers for the parallel loops in the library. Not installed with the public headers.
+namespace sentencpp::detail {
+
+    // Threads to use for work_items independent items. A request of 0 means one per hardware thread.
+    inline std::size_t resolve_threads(const std::size_t requested, const std::size_t work_items) {
+        std::size_t threads = requested;
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        return std::max<std::size_t>(1, std::min(threads, work_items));
+    }
+
+    // Runs fn(worker) on thread_count workers, the first of them on the calling thread.
+    template <typename Fn>
+    void run_workers(const std::size_t thread_count, Fn&& fn) {
+        std::vector<std::thread> workers;
+        workers.reserve(thread_count - 1);
+        for (std::size_t w = 1; w < thread_count; ++w) workers.emplace_back(fn, w);
+        fn(0);
+        for (auto& worker : workers) worker.join();
+    }
+
+} // namespace sentencpp::detail
@@ -0,0 +1,128 @@
+// Tests for the bounded queue that connects the stages of sentencpp_embed.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "BoundedQueue.h"
+
+using sentencpp::tools::BoundedQueue;
+
+namespace {
+
+    int failures = 0;
+
+    void check(const bool condition, const char* what) {
+        if (condition) return;
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+
+    // Runs work on its own thread so a deadlock fails the test instead of hanging it. The hung threads still reference
+    // the caller's queues, so a timeout exits the process straight away.
+    template <typename F>
+    void check_finishes(F&& work, const char* what, const std::chrono::seconds timeout = std::chrono::seconds(10)) {
+        std::packaged_task<void()> task(std::forward<F>(work));
+        std::future<void> done = task.get_future();
+        std::thread thread(std::move(task));
+        if (done.wait_for(timeout) != std::future_status::ready) {
+            std::cerr << "FAILED: " << what << " (timed out)" << std::endl;
+            std::_Exit(1);
+        }
+        thread.join();
+    }
+
+    void test_fifo() {
+        BoundedQueue<int> queue(4);
+        for (int i = 0; i < 4; ++i) check(queue.push(i), "push into an open queue succeeds");
+        queue.close();
+        for (int i = 0; i < 4; ++i) {
+            const auto item = queue.pop();
+            check(item && *item == i, "items are popped in order, even after close");
+        }
+        check(!queue.pop(), "pop returns nullopt once closed and drained");
+    }
+
+    void test_close_releases_blocked_push() {
+        BoundedQueue<int> queue(1);
+        check(queue.push(0), "push into an empty queue succeeds");
+
+        std::atomic<bool> pushed = true;
+        check_finishes([&] {
+            std::thread producer([&] { pushed = queue.push(1); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            queue.close();
+            producer.join();
+        }, "close wakes a producer blocked on a full queue");
+        check(!pushed, "push into a closed queue returns false");
+    }
+
+    // read -> work (4 threads) -> sink, where the sink fails on its first item and stops popping. Every queue is
+    // smaller than the input, so unless the failure closes every queue the work threads stay blocked pushing into a
+    // queue nobody pops.
+    void test_downstream_failure() {
+        constexpr int documents = 1000;
+        constexpr int work_threads = 4;
+
+        check_finishes([&] {
+            BoundedQueue<int> input_queue(4);
+            BoundedQueue<int> output_queue(4);
+            std::atomic<bool> failed = false;
+            std::atomic<int> remaining_workers = work_threads;
+
+            const auto fail = [&] {
+                if (failed.exchange(true)) return;
+                input_queue.close();
+                output_queue.close();
+            };
+
+            std::vector<std::thread> threads;
+            threads.emplace_back([&] {
+                for (int i = 0; i < documents && !failed; ++i) {
+                    if (!input_queue.push(i)) break;
+                }
+                input_queue.close();
+            });
+            for (int t = 0; t < work_threads; ++t) {
+                threads.emplace_back([&] {
+                    while (auto item = input_queue.pop()) output_queue.push(*item * 2);
+                    if (--remaining_workers == 0) output_queue.close();
+                });
+            }
+            threads.emplace_back([&] {
+                try {
+                    while (auto item = output_queue.pop()) {
+                        // Long enough for every upstream thread to block on a full queue.
+                        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                        throw std::runtime_error("sink failed");
+                    }
+                } catch (const std::exception&) {
+                    fail();
+                }
+            });
+
+            for (auto& thread : threads) thread.join();
+            check(failed, "the sink failure is recorded");
+        }, "a failing downstream stage does not deadlock the pipeline");
+    }
+
+} // namespace
+
+
+int main() {
+    test_fifo();
+    test_close_releases_blocked_push();
+    test_downstream_failure();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All bounded queue tests passed" << std::endl;
+    return 0;
+}
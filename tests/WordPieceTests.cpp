@@ -0,0 +1,116 @@
+// Tests for WordPiece encoding against a small tokenizer config written to a temporary file.
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sentenCPP/tokenizer/WordPiece.h>
+
+using namespace sentencpp::tokenizer;
+
+namespace {
+
+    int failures = 0;
+
+    void check(const bool condition, const char* what) {
+        if (condition) return;
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+
+    std::string write_config() {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "sentencpp_wordpiece_tests.json";
+        std::ofstream(path) << R"({
+            "added_tokens": [
+                {"id": 4, "content": "[MASK]", "normalized": false, "special": true},
+                {"id": 10, "content": "中文", "normalized": true, "special": false}
+            ],
+            "model": {"type": "WordPiece", "vocab": {
+                "[PAD]": 0, "[UNK]": 1, "[CLS]": 2, "[SEP]": 3, "[MASK]": 4,
+                "hello": 5, "world": 6, "中": 7, "文": 8, "!": 9
+            }}
+        })";
+        return path.string();
+    }
+
+    std::vector<int64_t> ids(const std::vector<Token>& tokens) {
+        std::vector<int64_t> result;
+        for (const auto& token : tokens) {
+            if (token.attention_mask == 1) result.push_back(token.id);
+        }
+        return result;
+    }
+
+    WordPieceConfig make_config(const std::string& path) {
+        WordPieceConfig config;
+        config.config_path = path;
+        config.max_length = 16;
+        config.warn_on_truncation = false;
+        return config;
+    }
+
+    void test_cjk_added_token(const std::string& path) {
+        const WordPiece tokenizer(make_config(path));
+        check(ids(tokenizer.tokenize("hello 中文 world")) == std::vector<int64_t>{2, 5, 10, 6, 3},
+              "a normalised added token made of CJK ideographs matches between words");
+        check(ids(tokenizer.tokenize("hello中文!")) == std::vector<int64_t>{2, 5, 10, 9, 3},
+              "a normalised added token made of CJK ideographs matches inside a word");
+        check(ids(tokenizer.tokenize("中 文")) == std::vector<int64_t>{2, 7, 8, 3},
+              "separated ideographs are not matched as the added token");
+        check(ids(tokenizer.tokenize("文中")) == std::vector<int64_t>{2, 8, 7, 3},
+              "unmatched ideographs are split one per word");
+    }
+
+    void test_max_length(const std::string& path) {
+        WordPieceConfig config = make_config(path);
+        config.max_length = 1;
+        bool rejected = false;
+        try {
+            const WordPiece tokenizer(config);
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        check(rejected, "max_length below 2 is rejected");
+
+        config.max_length = 2;
+        const WordPiece tokenizer(config);
+        std::vector<int64_t> input_ids(2), attention_mask(2), segment_ids(2);
+        const EncodingBuffers buffers{input_ids, attention_mask, segment_ids};
+        TokenizerScratch scratch;
+        check(tokenizer.tokenize("hello world", scratch, buffers) == 2,
+              "max_length 2 keeps only [CLS] and [SEP]");
+        check(input_ids == std::vector<int64_t>{2, 3}, "max_length 2 writes [CLS] [SEP]");
+
+        bool pair_rejected = false;
+        try {
+            static_cast<void>(tokenizer.tokenize_pair("hello", "world", scratch, buffers));
+        } catch (const std::invalid_argument&) {
+            pair_rejected = true;
+        }
+        check(pair_rejected, "pair encoding with max_length below 3 is rejected");
+
+        config.max_length = 3;
+        const WordPiece pair_tokenizer(config);
+        check(ids(pair_tokenizer.tokenize_pair("hello", "world")) == std::vector<int64_t>{2, 3, 3},
+              "pair encoding with max_length 3 keeps only [CLS] [SEP] [SEP]");
+    }
+
+} // namespace
+
+
+int main() {
+    const std::string path = write_config();
+    test_cjk_added_token(path);
+    test_max_length(path);
+    std::filesystem::remove(path);
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All WordPiece tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace sentencpp::tools {
+
+    // Multi-producer, multi-consumer FIFO. push blocks while full, pop blocks while empty.
+    //
+    // Closing the queue wakes every blocked thread: producers give up, consumers drain what is left. A pipeline that
+    // hits an error closes all of its queues, so no stage can stay blocked on a neighbour that has stopped.
+    template <typename T>
+    class BoundedQueue {
+        public:
+            explicit BoundedQueue(const std::size_t capacity) : capacity_(capacity) {}
+
+            // Returns false, dropping the item, if the queue is closed before there is room for it.
+            bool push(T item) {
+                std::unique_lock lock(mutex_);
+                not_full_.wait(lock, [&] { return items_.size() < capacity_ || closed_; });
+                if (closed_) return false;
+                items_.push_back(std::move(item));
+                not_empty_.notify_one();
+                return true;
+            }
+
+            // Returns std::nullopt once the queue is closed and drained.
+            std::optional<T> pop() {
+                std::unique_lock lock(mutex_);
+                not_empty_.wait(lock, [&] { return !items_.empty() || closed_; });
+                if (items_.empty()) return std::nullopt;
+                T item = std::move(items_.front());
+                items_.pop_front();
+                not_full_.notify_one();
+                return item;
+            }
+
+            void close() {
+                std::lock_guard lock(mutex_);
+                closed_ = true;
+                not_empty_.notify_all();
+                not_full_.notify_all();
+            }
+
+        private:
+            std::size_t capacity_;
+            std::deque<T> items_;
+            bool closed_ = false;
+            std::mutex mutex_;
+            std::condition_variable not_full_;
+            std::condition_variable not_empty_;
+    };
+
+} // namespace sentencpp::tools
@@ -0,0 +1,591 @@
+// sentencpp_embed: streams a corpus through tokenize -> batched inference -> mean pooling and writes the sentence
+// embeddings to an EmbeddingStore, optionally reduced with Matryoshka truncation or a fitted PCA projection.
+//
+// Stages run on their own threads and are connected by bounded queues, so a slow stage applies backpressure to the
+// ones before it instead of letting memory grow:
+//
+//   read (1) -> tokenize (N) -> batch (1) -> infer (M) -> pool (1) -> write (1)
+//
+// Documents are grouped into batches of similar token length to keep padding low, so rows are written out of input
+// order. Each row carries its document id: the numeric id field for JSONL input, or the zero-based line number.
+// An interrupted run is resumed with --append, which skips every id already flushed to the store.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <sentenCPP/tokenizer/WordPiece.h>
+#include <sentenCPP/inference/OnnxEngine.h>
+#include <sentenCPP/embedding_utils/VectorMaths.h>
+#include <sentenCPP/embedding_utils/EmbeddingStore.h>
+#include <sentenCPP/embedding_utils/DimensionReduction.h>
+
+#include "BoundedQueue.h"
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+using sentencpp::tools::BoundedQueue;
+
+namespace {
+
+    struct Options {
+        std::string tokenizer_path;
+        std::string model_path;
+        std::string output_path;
+        std::string input_path = "-";
+        std::string output_name = "last_hidden_state";
+        std::string fingerprint;
+        std::size_t truncate_dimension = 0;
+        std::string pca_path;
+        bool append = false;
+        bool overwrite = false;
+        bool jsonl = false;
+        std::string text_field = "text";
+        std::string id_field = "id";
+        // Inference dominates the run, so by default tokenization gets an eighth of the hardware threads and a single
+        // session gets the rest as ORT intra-op threads. 0 intra-op threads is resolved once the options are parsed.
+        std::size_t tokenize_threads = std::max(1u, std::thread::hardware_concurrency() / 8);
+        std::size_t infer_threads = 1;
+        std::size_t intra_op_threads = 0;
+        std::size_t batch_size = 32;
+        std::size_t max_length = 128;
+        std::size_t queue_capacity = 64;
+        std::size_t read_chunk = 256;
+        std::size_t bucket_width = 16;
+    };
+
+    // Time spent doing work, as opposed to waiting on a queue.
+    struct StageStats {
+        std::string name;
+        std::size_t threads;
+        std::atomic<int64_t> busy_ns = 0;
+
+        StageStats(std::string name, const std::size_t threads) : name(std::move(name)), threads(threads) {}
+
+        template <typename F>
+        auto time(F&& work) {
+            const auto start = Clock::now();
+            struct Record {
+                std::atomic<int64_t>& busy_ns;
+                Clock::time_point start;
+                ~Record() {
+                    busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+                }
+            } record{busy_ns, start};
+            return work();
+        }
+    };
+
+    // Closes a queue once every thread of the producing stage has finished.
+    class StageLatch {
+        public:
+            StageLatch(const std::size_t producers, std::function<void()> on_done) :
+                remaining_(producers), on_done_(std::move(on_done)) {}
+
+            void done() {
+                if (--remaining_ == 0) on_done_();
+            }
+
+        private:
+            std::atomic<std::size_t> remaining_;
+            std::function<void()> on_done_;
+    };
+
+    struct Document {
+        uint64_t id;
+        std::string text;
+    };
+
+    struct EncodedDocument {
+        uint64_t id;
+        std::vector<int64_t> input_ids;  // Real tokens only, including [CLS] and [SEP].
+    };
+
+    struct Batch {
+        std::vector<uint64_t> ids;
+        std::vector<int64_t> input_ids;
+        std::vector<int64_t> attention_mask;
+        std::vector<int64_t> segment_ids;
+        std::size_t rows = 0;
+        std::size_t length = 0;
+    };
+
+    struct InferredBatch {
+        std::vector<uint64_t> ids;
+        std::vector<int64_t> attention_mask;
+        std::size_t rows = 0;
+        std::size_t length = 0;
+        sentencpp::inference::TensorOutput output;
+    };
+
+    struct PooledBatch {
+        std::vector<uint64_t> ids;
+        std::vector<float> embeddings;  // Row-major [ids.size(), dimension].
+    };
+
+    void print_usage() {
+        std::cerr <<
+            "Usage: sentencpp_embed --tokenizer tokenizer.json --model model.onnx --output vectors.bin [options]\n"
+            "\n"
+            "  --input PATH           Corpus file, one document per line. '-' reads stdin (default).\n"
+            "  --jsonl                Parse each line as JSON; see --text-field and --id-field.\n"
+            "  --text-field NAME      JSONL field holding the text (default: text).\n"
+            "  --id-field NAME        JSONL field holding a numeric id (default: id). Falls back to the line number.\n"
+            "  --output-name NAME     Model output to pool (default: last_hidden_state).\n"
+            "  --fingerprint STRING   Model fingerprint stored in the output header (default: model path).\n"
+            "  --truncate-dim N       Keep the first N dimensions of each embedding and renormalise (Matryoshka models).\n"
+            "  --pca PATH             Project embeddings with a PCA projection saved by PcaProjection::save.\n"
+            "  --append               Add to an existing output, skipping ids it already holds (resumes a run).\n"
+            "  --overwrite            Replace an existing output.\n"
+            "  --tokenize-threads N   Tokenizer threads (default: an eighth of the hardware threads).\n"
+            "  --infer-threads N      Inference threads, each with its own session (default: 1).\n"
+            "  --intra-op-threads N   ORT threads per session (default: the hardware threads left after tokenization,\n"
+            "                         split across sessions).\n"
+            "  --batch-size N         Documents per inference batch (default: 32).\n"
+            "  --max-length N         Maximum tokens per document (default: 128).\n"
+            "  --queue-capacity N     Capacity of each inter-stage queue (default: 64).\n";
+    }
+
+    std::optional<Options> parse_options(const int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+
+            if (arg == "--tokenizer") options.tokenizer_path = value();
+            else if (arg == "--model") options.model_path = value();
+            else if (arg == "--output") options.output_path = value();
+            else if (arg == "--input") options.input_path = value();
+            else if (arg == "--jsonl") options.jsonl = true;
+            else if (arg == "--text-field") options.text_field = value();
+            else if (arg == "--id-field") options.id_field = value();
+            else if (arg == "--output-name") options.output_name = value();
+            else if (arg == "--fingerprint") options.fingerprint = value();
+            else if (arg == "--truncate-dim") options.truncate_dimension = std::stoul(value());
+            else if (arg == "--pca") options.pca_path = value();
+            else if (arg == "--append") options.append = true;
+            else if (arg == "--overwrite") options.overwrite = true;
+            else if (arg == "--tokenize-threads") options.tokenize_threads = std::stoul(value());
+            else if (arg == "--infer-threads") options.infer_threads = std::stoul(value());
+            else if (arg == "--intra-op-threads") options.intra_op_threads = std::stoul(value());
+            else if (arg == "--batch-size") options.batch_size = std::stoul(value());
+            else if (arg == "--max-length") options.max_length = std::stoul(value());
+            else if (arg == "--queue-capacity") options.queue_capacity = std::stoul(value());
+            else if (arg == "--help" || arg == "-h") return std::nullopt;
+            else throw std::invalid_argument("Unknown option " + arg);
+        }
+
+        if (options.tokenizer_path.empty() || options.model_path.empty() || options.output_path.empty()) {
+            throw std::invalid_argument("--tokenizer, --model and --output are required.");
+        }
+        if (options.tokenize_threads == 0 || options.infer_threads == 0 || options.batch_size == 0 || options.queue_capacity == 0) {
+            throw std::invalid_argument("Thread counts, batch size and queue capacity must be greater than zero.");
+        }
+        // [CLS] and [SEP] around at least one token.
+        if (options.max_length < 3) throw std::invalid_argument("--max-length must be at least 3.");
+        if (options.truncate_dimension > 0 && !options.pca_path.empty()) {
+            throw std::invalid_argument("--truncate-dim and --pca cannot be combined.");
+        }
+        if (options.append && options.overwrite) {
+            throw std::invalid_argument("--append and --overwrite cannot be combined.");
+        }
+        if (options.intra_op_threads == 0) {
+            const std::size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+            const std::size_t spare = hardware_threads - std::min(hardware_threads - 1, options.tokenize_threads);
+            options.intra_op_threads = std::max<std::size_t>(1, spare / options.infer_threads);
+        }
+        if (options.fingerprint.empty()) options.fingerprint = options.model_path.substr(
+            options.model_path.size() > 64 ? options.model_path.size() - 64 : 0
+        );
+        return options;
+    }
+
+    // Pads a set of similar-length documents into one [rows, length] batch.
+    Batch make_batch(std::vector<EncodedDocument>& documents, const int64_t padding_id) {
+        Batch batch;
+        batch.rows = documents.size();
+        for (const auto& document : documents) batch.length = std::max(batch.length, document.input_ids.size());
+
+        batch.ids.reserve(batch.rows);
+        batch.input_ids.assign(batch.rows * batch.length, padding_id);
+        batch.attention_mask.assign(batch.rows * batch.length, 0);
+        batch.segment_ids.assign(batch.rows * batch.length, 0);
+
+        for (std::size_t row = 0; row < batch.rows; ++row) {
+            const auto& document = documents[row];
+            const std::size_t offset = row * batch.length;
+            batch.ids.push_back(document.id);
+            std::ranges::copy(document.input_ids, batch.input_ids.begin() + offset);
+            std::fill_n(batch.attention_mask.begin() + offset, document.input_ids.size(), 1);
+        }
+        documents.clear();
+        return batch;
+    }
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        const auto parsed = parse_options(argc, argv);
+        if (!parsed) {
+            print_usage();
+            return 0;
+        }
+        options = *parsed;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        print_usage();
+        return 1;
+    }
+
+    try {
+        std::ios::sync_with_stdio(false);
+
+        // Reopening a store appends to it, so an existing output is only touched when the caller says how.
+        std::unordered_set<uint64_t> existing_ids;
+        std::error_code error;
+        const auto output_size = std::filesystem::file_size(options.output_path, error);
+        if (!error && output_size > 0) {
+            if (options.overwrite) {
+                std::filesystem::remove(options.output_path);
+                std::filesystem::remove(options.output_path + ".ids");
+            } else if (options.append) {
+                const sentencpp::embedding_utils::EmbeddingStoreReader store(options.output_path);
+                if (store.model_fingerprint() != options.fingerprint) {
+                    throw std::runtime_error("Output file was written with a different model: " + options.output_path);
+                }
+                existing_ids.insert(store.ids().begin(), store.ids().end());
+            } else {
+                throw std::runtime_error(
+                    "Output file already exists: " + options.output_path + ". Pass --append or --overwrite."
+                );
+            }
+        }
+
+        sentencpp::tokenizer::WordPieceConfig tokenizer_config;
+        tokenizer_config.config_path = options.tokenizer_path;
+        tokenizer_config.max_length = options.max_length;
+        tokenizer_config.warn_on_truncation = false;
+        const sentencpp::tokenizer::WordPiece tokenizer(tokenizer_config);
+        const int64_t padding_id = tokenizer.get_vocab_list().token_to_id(tokenizer_config.padding_token).value();
+
+        sentencpp::inference::ModelConfig model_config;
+        model_config.model_path = options.model_path;
+        model_config.output_name = options.output_name;
+        model_config.intra_op_threads = static_cast<int>(options.intra_op_threads);
+        std::vector<std::unique_ptr<sentencpp::inference::OnnxEngine>> engines;
+        for (std::size_t i = 0; i < options.infer_threads; ++i) {
+            engines.push_back(std::make_unique<sentencpp::inference::OnnxEngine>(model_config));
+        }
+
+        // Truncation needs the model's hidden size, so it is created once the first batch has been pooled.
+        std::unique_ptr<sentencpp::embedding_utils::ProjectionInterface> projection;
+        if (!options.pca_path.empty()) {
+            projection = std::make_unique<sentencpp::embedding_utils::PcaProjection>(options.pca_path);
+        }
+
+        std::ifstream input_file;
+        if (options.input_path != "-") {
+            input_file.open(options.input_path);
+            if (!input_file.is_open()) throw std::runtime_error("Unable to open input file: " + options.input_path);
+        }
+        std::istream& input = options.input_path == "-" ? std::cin : input_file;
+
+        const std::size_t capacity = options.queue_capacity;
+        BoundedQueue<std::vector<Document>> read_queue(capacity);
+        BoundedQueue<std::vector<EncodedDocument>> encoded_queue(capacity);
+        BoundedQueue<Batch> batch_queue(capacity);
+        BoundedQueue<InferredBatch> inferred_queue(capacity);
+        BoundedQueue<PooledBatch> pooled_queue(capacity);
+
+        StageStats read_stats("read", 1);
+        StageStats tokenize_stats("tokenize", options.tokenize_threads);
+        StageStats batch_stats("batch", 1);
+        StageStats infer_stats("infer", options.infer_threads);
+        StageStats pool_stats("pool", 1);
+        StageStats write_stats("write", 1);
+
+        std::atomic<uint64_t> documents_read = 0;
+        std::atomic<uint64_t> documents_written = 0;
+        std::atomic<uint64_t> documents_truncated = 0;
+        std::atomic<uint64_t> documents_skipped = 0;
+        std::atomic<uint64_t> parse_errors = 0;
+        std::atomic<bool> failed = false;
+        std::atomic<bool> finished = false;
+        const auto start = Clock::now();
+
+        // Any stage failure is reported once and closes every queue: blocked producers give up, and consumers skip
+        // whatever is left, so every thread can exit.
+        const auto fail = [&](const std::exception& e) {
+            if (failed.exchange(true)) return;
+            std::cerr << "Error: " << e.what() << std::endl;
+            read_queue.close();
+            encoded_queue.close();
+            batch_queue.close();
+            inferred_queue.close();
+            pooled_queue.close();
+        };
+
+        std::vector<std::thread> threads;
+
+        // Read.
+        threads.emplace_back([&] {
+            try {
+                std::string line;
+                uint64_t line_number = 0;
+                bool more = true;
+                while (more && !failed) {
+                    std::vector<Document> chunk;
+                    chunk.reserve(options.read_chunk);
+                    read_stats.time([&] {
+                        while (chunk.size() < options.read_chunk && (more = static_cast<bool>(std::getline(input, line)))) {
+                            const uint64_t line_id = line_number++;
+                            if (line.empty()) continue;
+                            if (!options.jsonl) {
+                                if (existing_ids.contains(line_id)) documents_skipped++;
+                                else chunk.push_back(Document{line_id, std::move(line)});
+                                continue;
+                            }
+
+                            const json record = json::parse(line, nullptr, false);
+                            const auto text_it = record.is_discarded() ? record.end() : record.find(options.text_field);
+                            if (text_it == record.end() || !text_it->is_string()) {
+                                parse_errors++;
+                                continue;
+                            }
+                            const auto id_it = record.find(options.id_field);
+                            const bool numeric_id = id_it != record.end() && id_it->is_number_unsigned();
+                            const uint64_t id = numeric_id ? id_it->get<uint64_t>() : line_id;
+                            if (existing_ids.contains(id)) documents_skipped++;
+                            else chunk.push_back(Document{id, text_it->get<std::string>()});
+                        }
+                    });
+                    documents_read += chunk.size();
+                    if (!chunk.empty() && !read_queue.push(std::move(chunk))) break;
+                }
+            } catch (const std::exception& e) {
+                fail(e);
+            }
+            read_queue.close();
+        });
+
+        // Tokenize.
+        StageLatch tokenize_latch(options.tokenize_threads, [&] { encoded_queue.close(); });
+        for (std::size_t t = 0; t < options.tokenize_threads; ++t) {
+            threads.emplace_back([&] {
+                sentencpp::tokenizer::TokenizerScratch scratch;
+                std::vector<int64_t> input_ids(options.max_length), attention_mask(options.max_length), segment_ids(options.max_length);
+                const sentencpp::tokenizer::EncodingBuffers buffers{input_ids, attention_mask, segment_ids};
+
+                while (auto chunk = read_queue.pop()) {
+                    if (failed) continue;
+                    try {
+                        std::vector<EncodedDocument> encoded;
+                        encoded.reserve(chunk->size());
+                        tokenize_stats.time([&] {
+                            for (const auto& document : *chunk) {
+                                const std::size_t n = tokenizer.tokenize(document.text, scratch, buffers);
+                                if (n == options.max_length) documents_truncated++;
+                                encoded.push_back(EncodedDocument{
+                                    document.id, std::vector<int64_t>(input_ids.begin(), input_ids.begin() + static_cast<std::ptrdiff_t>(n))
+                                });
+                            }
+                        });
+                        encoded_queue.push(std::move(encoded));
+                    } catch (const std::exception& e) {
+                        fail(e);
+                    }
+                }
+                tokenize_latch.done();
+            });
+        }
+
+        // Batch: bucket documents by token length so each batch carries little padding.
+        threads.emplace_back([&] {
+            std::vector<std::vector<EncodedDocument>> buckets(options.max_length / options.bucket_width + 1);
+            while (auto encoded = encoded_queue.pop()) {
+                if (failed) continue;
+                try {
+                    std::vector<Batch> ready;
+                    batch_stats.time([&] {
+                        for (auto& document : *encoded) {
+                            auto& bucket = buckets[document.input_ids.size() / options.bucket_width];
+                            bucket.push_back(std::move(document));
+                            if (bucket.size() == options.batch_size) ready.push_back(make_batch(bucket, padding_id));
+                        }
+                    });
+                    for (auto& batch : ready) batch_queue.push(std::move(batch));
+                } catch (const std::exception& e) {
+                    fail(e);
+                }
+            }
+            try {
+                for (auto& bucket : buckets) {
+                    if (!bucket.empty() && !failed) batch_queue.push(make_batch(bucket, padding_id));
+                }
+            } catch (const std::exception& e) {
+                fail(e);
+            }
+            batch_queue.close();
+        });
+
+        // Infer.
+        StageLatch infer_latch(options.infer_threads, [&] { inferred_queue.close(); });
+        for (std::size_t t = 0; t < options.infer_threads; ++t) {
+            threads.emplace_back([&, t] {
+                while (auto batch = batch_queue.pop()) {
+                    if (failed) continue;
+                    try {
+                        InferredBatch inferred = infer_stats.time([&] {
+                            return InferredBatch{
+                                std::move(batch->ids),
+                                batch->attention_mask,
+                                batch->rows,
+                                batch->length,
+                                engines[t]->run(sentencpp::inference::BatchInputs{
+                                    batch->input_ids,
+                                    batch->attention_mask,
+                                    batch->segment_ids,
+                                    static_cast<int64_t>(batch->rows),
+                                    static_cast<int64_t>(batch->length)
+                                })
+                            };
+                        });
+                        inferred_queue.push(std::move(inferred));
+                    } catch (const std::exception& e) {
+                        fail(e);
+                    }
+                }
+                infer_latch.done();
+            });
+        }
+
+        // Pool.
+        threads.emplace_back([&] {
+            while (auto inferred = inferred_queue.pop()) {
+                if (failed) continue;
+                try {
+                    PooledBatch pooled = pool_stats.time([&] {
+                        const auto& shape = inferred->output.shape;
+                        const std::vector<float>& data = inferred->output.data;
+                        PooledBatch result{std::move(inferred->ids), {}};
+
+                        if (shape.size() == 2) {
+                            // The model already pools, eg: a sentence_embedding output.
+                            result.embeddings = data;
+                        } else if (shape.size() == 3) {
+                            const auto hidden_size = static_cast<std::size_t>(shape[2]);
+                            const std::size_t length = inferred->length;
+                            result.embeddings.resize(inferred->rows * hidden_size);
+                            for (std::size_t row = 0; row < inferred->rows; ++row) {
+                                sentencpp::embedding_utils::VectorMaths::mean_pooling(
+                                    std::span(data).subspan(row * length * hidden_size, length * hidden_size),
+                                    std::span(inferred->attention_mask).subspan(row * length, length),
+                                    std::span(result.embeddings).subspan(row * hidden_size, hidden_size)
+                                );
+                            }
+                        } else {
+                            throw std::runtime_error("Model output must be 2D or 3D to be pooled.");
+                        }
+
+                        const std::size_t hidden_size = result.embeddings.size() / inferred->rows;
+                        if (!projection && options.truncate_dimension > 0) {
+                            projection = std::make_unique<sentencpp::embedding_utils::MatryoshkaTruncation>(
+                                hidden_size, options.truncate_dimension
+                            );
+                        }
+                        if (projection) {
+                            std::vector<float> projected(inferred->rows * projection->output_dimension());
+                            projection->project(sentencpp::embedding_utils::MatrixView{
+                                result.embeddings.data(), inferred->rows, hidden_size, hidden_size
+                            }, projected);
+                            result.embeddings = std::move(projected);
+                        }
+                        return result;
+                    });
+                    pooled_queue.push(std::move(pooled));
+                } catch (const std::exception& e) {
+                    fail(e);
+                }
+            }
+            pooled_queue.close();
+        });
+
+        // Write.
+        threads.emplace_back([&] {
+            std::unique_ptr<sentencpp::embedding_utils::EmbeddingStoreWriter> writer;
+            while (auto pooled = pooled_queue.pop()) {
+                if (failed || pooled->ids.empty()) continue;
+                try {
+                    write_stats.time([&] {
+                        if (!writer) {
+                            const std::size_t dimension = pooled->embeddings.size() / pooled->ids.size();
+                            writer = std::make_unique<sentencpp::embedding_utils::EmbeddingStoreWriter>(
+                                options.output_path, dimension, options.fingerprint
+                            );
+                        }
+                        writer->append(pooled->ids, pooled->embeddings);
+                    });
+                    documents_written += pooled->ids.size();
+                } catch (const std::exception& e) {
+                    fail(e);
+                }
+            }
+            try {
+                if (writer) write_stats.time([&] { writer->flush(); });
+            } catch (const std::exception& e) {
+                fail(e);
+            }
+            finished = true;
+        });
+
+        // Progress.
+        auto last_report = Clock::now();
+        while (!finished) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (Clock::now() - last_report < std::chrono::seconds(5)) continue;
+            last_report = Clock::now();
+            const double elapsed = std::chrono::duration<double>(last_report - start).count();
+            std::cerr << "read " << documents_read << ", written " << documents_written << " ("
+                      << std::fixed << std::setprecision(1) << static_cast<double>(documents_written) / elapsed
+                      << " docs/s)" << std::endl;
+        }
+
+        for (auto& thread : threads) thread.join();
+
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cerr << std::fixed << std::setprecision(1)
+                  << "\nDocuments: " << documents_written << " in " << elapsed << " s ("
+                  << static_cast<double>(documents_written) / elapsed << " docs/s)\n"
+                  << "Reached max_length: " << documents_truncated << ", unparseable lines: " << parse_errors
+                  << ", already in output: " << documents_skipped << "\n\n"
+                  << std::left << std::setw(10) << "Stage" << std::setw(10) << "Threads" << "Utilisation\n";
+        for (const StageStats* stats : {&read_stats, &tokenize_stats, &batch_stats, &infer_stats, &pool_stats, &write_stats}) {
+            const double busy = static_cast<double>(stats->busy_ns.load()) / 1e9;
+            std::cerr << std::setw(10) << stats->name << std::setw(10) << stats->threads
+                      << 100.0 * busy / (elapsed * static_cast<double>(stats->threads)) << " %\n";
+        }
+
+        return failed ? 1 : 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}